@@ -124,8 +124,13 @@ int main(void) {
         fprintf(stderr, "%d ", iv[i]);
     fputc('\n', stderr);
 
-    // This is hard reset - zeroing all the elements via memset(..., 0, ...).
-    memset(iv, 0, mvcap(iv) * mvelsz(iv));
+    // This is hard reset - setting all the elements up to the capacity to the
+    // same value via mvfill(). If you need zeroed elements right after the
+    // allocation, use mvcalloc() instead of mvalloc() + mvfill(): large chunks
+    // come zeroed from the system for free. Similarly, mvresize_zeroed()
+    // zeroes only the elements added by growing.
+    int zero = 0;
+    mvfill(iv, &zero);
     // Assert that all the elements in the allocated area are zeroed out
     for (size_t i = 0; i < mvcap(iv); i++)
         assert(iv[i] == 0);
@@ -0,0 +1,450 @@
+// mvbits.h - Packed bit vector in a monolithic vector
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVBITS_H
+#define MVBITS_H
+
+#include <stdint.h> // uint64_t
+
+#include "mvec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+// Amount of bits covered by a single entry of the rank directory
+#define MVBITS_SUPERBLOCK 512
+
+// A bit vector lives in the data of a byte mvec, so it is allocated and
+// resized by the core functions [with the allocator it was allocated with].
+// The header is followed by 64-bit words storing the bits, bit i being bit
+// i % 64 of word i / 64. Bits past the length are always kept zero.
+//
+// The rank directory is a separate uint64_t mvec storing the amount of set
+// bits before every MVBITS_SUPERBLOCK bits. It is only built by
+// mvbits_index(), which updates just the part invalidated by modifications
+// since its previous call, so indexing a vector that only gets appended to
+// costs proportionally to the appended bits
+typedef struct mvbits_header_t {
+    size_t length; // in bits
+    size_t capacity; // in bits, a multiple of 64
+    size_t rank_valid; // amount of up to date entries of ranks
+    mvdef uint64_t* ranks;
+} MvbitsHeader;
+
+// Use this typedef for bit vectors. Release them with mvbits_free()
+typedef MvbitsHeader mvbits_t;
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+mvbits_t* mvbits_alloc(size_t capacity);
+mvbits_t* mvbits_resize(mvbits_t* bits, size_t new_capacity);
+mvbits_t* mvbits_push(mvbits_t* bits, int value);
+void mvbits_free(mvbits_t* bits);
+void mvbits_and(mvbits_t* dest, mvbits_t* src);
+void mvbits_or(mvbits_t* dest, mvbits_t* src);
+void mvbits_xor(mvbits_t* dest, mvbits_t* src);
+void mvbits_andnot(mvbits_t* dest, mvbits_t* src);
+size_t mvbits_popcount(mvbits_t* bits);
+int mvbits_index(mvbits_t* bits);
+size_t mvbits_rank(mvbits_t* bits, size_t index);
+size_t mvbits_select(mvbits_t* bits, size_t rank);
+static inline size_t mvbits_len(mvbits_t* bits);
+static inline size_t mvbits_cap(mvbits_t* bits);
+static inline uint64_t* mvbits_words(mvbits_t* bits);
+static inline int mvbits_test(mvbits_t* bits, size_t index);
+static inline void mvbits_set(mvbits_t* bits, size_t index, int value);
+static inline void mvbits_flip(mvbits_t* bits, size_t index);
+
+// Returns length of the given bit vector in bits.
+// UB: bits == NULL or address of not a valid bit vector
+static inline size_t mvbits_len(mvbits_t* bits) {
+    return bits->length;
+}
+
+// Returns capacity of the given bit vector in bits. Consider modifying it via
+// mvbits_resize().
+// UB: bits == NULL or address of not a valid bit vector
+static inline size_t mvbits_cap(mvbits_t* bits) {
+    return bits->capacity;
+}
+
+// Returns a pointer to the first word of the given bit vector. Writing to the
+// words directly does not invalidate the rank directory and must keep the
+// bits past the length zero.
+// UB: bits == NULL or address of not a valid bit vector
+static inline uint64_t* mvbits_words(mvbits_t* bits) {
+    return (uint64_t*)(bits + 1);
+}
+
+// Marks the rank directory as outdated starting from the entry right after
+// the superblock containing the given bit
+static inline void mvbits_touch(mvbits_t* bits, size_t index) {
+    size_t first_outdated = index / MVBITS_SUPERBLOCK + 1;
+    if (bits->rank_valid > first_outdated) bits->rank_valid = first_outdated;
+}
+
+// Returns the value of the given bit.
+// UB:
+//  @ bits == NULL or address of not a valid bit vector
+//  @ index >= mvbits_len(bits)
+static inline int mvbits_test(mvbits_t* bits, size_t index) {
+    return (int)(mvbits_words(bits)[index / 64] >> (index % 64) & 1);
+}
+
+// Sets the given bit to 1 if value is nonzero, to 0 otherwise.
+// UB:
+//  @ bits == NULL or address of not a valid bit vector
+//  @ index >= mvbits_len(bits)
+static inline void mvbits_set(mvbits_t* bits, size_t index, int value) {
+    uint64_t* word = &mvbits_words(bits)[index / 64];
+    uint64_t mask = (uint64_t)1 << (index % 64);
+    *word = value ? *word | mask : *word & ~mask;
+    mvbits_touch(bits, index);
+}
+
+// Inverts the given bit.
+// UB:
+//  @ bits == NULL or address of not a valid bit vector
+//  @ index >= mvbits_len(bits)
+static inline void mvbits_flip(mvbits_t* bits, size_t index) {
+    mvbits_words(bits)[index / 64] ^= (uint64_t)1 << (index % 64);
+    mvbits_touch(bits, index);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#ifdef MVBITS_IMPLEMENTATION
+#undef MVBITS_IMPLEMENTATION
+
+#include <string.h> // memset
+
+#if defined(__AVX512VPOPCNTDQ__) || defined(__AVX2__) || defined(__BMI2__)
+#include <immintrin.h> // AVX2, AVX-512 and BMI2 intrinsics
+#endif // __AVX512VPOPCNTDQ__ || __AVX2__ || __BMI2__
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+static inline size_t mvbits_wordsFor(size_t bits) {
+    return (bits + 63) / 64;
+}
+
+static inline unsigned mvbits_popcount64(uint64_t word) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_popcountll(word);
+#else // !__GNUC__
+    word -= word >> 1 & 0x5555555555555555ull;
+    word = (word & 0x3333333333333333ull) + (word >> 2 & 0x3333333333333333ull);
+    word = (word + (word >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (unsigned)(word * 0x0101010101010101ull >> 56);
+#endif // __GNUC__
+}
+
+// Counts set bits of the given words. AVX-512 VPOPCNTDQ counts 8 words per
+// instruction; AVX2 looks up the counts of every nibble in a shuffle table and
+// sums them with SAD, 4 words at a time
+static size_t mvbits_popcountWords(const uint64_t* words, size_t quantity) {
+    size_t count = 0;
+    size_t i = 0;
+#if defined(__AVX512VPOPCNTDQ__)
+    __m512i acc = _mm512_setzero_si512();
+    for (; i + 8 <= quantity; i += 8)
+        acc = _mm512_add_epi64(
+                acc,
+                _mm512_popcnt_epi64(_mm512_loadu_si512(words + i))
+                );
+    count += (size_t)_mm512_reduce_add_epi64(acc);
+#elif defined(__AVX2__)
+    const __m256i table = _mm256_setr_epi8(
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+            0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4
+            );
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+    for (; i + 4 <= quantity; i += 4) {
+        __m256i v = _mm256_loadu_si256((const __m256i*)(words + i));
+        __m256i lo = _mm256_and_si256(v, low_nibbles);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_nibbles);
+        __m256i bytes = _mm256_add_epi8(
+                _mm256_shuffle_epi8(table, lo),
+                _mm256_shuffle_epi8(table, hi)
+                );
+        acc = _mm256_add_epi64(
+                acc,
+                _mm256_sad_epu8(bytes, _mm256_setzero_si256())
+                );
+    }
+    count += (size_t)_mm256_extract_epi64(acc, 0)
+        + (size_t)_mm256_extract_epi64(acc, 1)
+        + (size_t)_mm256_extract_epi64(acc, 2)
+        + (size_t)_mm256_extract_epi64(acc, 3);
+#endif // __AVX512VPOPCNTDQ__ / __AVX2__
+    for (; i < quantity; i++)
+        count += mvbits_popcount64(words[i]);
+    return count;
+}
+
+// Returns the position of the rank-th (counting from 0) set bit of the word
+static inline unsigned mvbits_select64(uint64_t word, unsigned rank) {
+#if defined(__BMI2__) && defined(__x86_64__) && defined(__GNUC__)
+    return (unsigned)__builtin_ctzll(_pdep_u64((uint64_t)1 << rank, word));
+#else // !__BMI2__
+    while (rank--) word &= word - 1;
+    unsigned position = 0;
+    while (!(word & 1)) {
+        word >>= 1;
+        position++;
+    }
+    return position;
+#endif // __BMI2__
+}
+
+// Allocates a new bit vector able to store the given capacity of bits (rounded
+// up to a multiple of 64). Sets length to 0 and all the bits to 0. On success,
+// returns a pointer to the newly allocated bit vector. On failure, returns
+// NULL.
+// [UB: current allocator is not set with mvec_setAllocator()]
+mvbits_t* mvbits_alloc(size_t capacity) {
+    size_t words = mvbits_wordsFor(capacity);
+    size_t bytes = sizeof(MvbitsHeader) + words * sizeof(uint64_t);
+    mvbits_t* bits = (mvbits_t*)mvalloc(bytes, 1);
+    if (!bits) return NULL;
+    *mvlen(bits) = bytes;
+    bits->length = 0;
+    bits->capacity = words * 64;
+    bits->rank_valid = 0;
+    bits->ranks = NULL;
+    memset(mvbits_words(bits), 0, words * sizeof(uint64_t));
+    return bits;
+}
+
+// Reallocates the given bit vector to store the given new_capacity of bits
+// (rounded up to a multiple of 64). If length exceeds new_capacity, it gets
+// leveled to it and all the trimmed bits are lost. Added bits are set to 0.
+// On success, returns a pointer to the reallocated bit vector; its pointer's
+// previous value gets invalidated. On failure, returns NULL; the state and the
+// data of the given bit vector remain untouched.
+// UB: bits == NULL or address of not a valid bit vector
+mvbits_t* mvbits_resize(mvbits_t* bits, size_t new_capacity) {
+    size_t old_words = bits->capacity / 64;
+    size_t words = mvbits_wordsFor(new_capacity);
+    size_t bytes = sizeof(MvbitsHeader) + words * sizeof(uint64_t);
+    mvbits_t* new_bits = (mvbits_t*)mvresize(bits, bytes);
+    if (!new_bits) return NULL;
+    *mvlen(new_bits) = bytes;
+    new_bits->capacity = words * 64;
+    if (words > old_words)
+        memset(mvbits_words(new_bits) + old_words, 0,
+                (words - old_words) * sizeof(uint64_t));
+    if (new_bits->length > new_capacity) {
+        new_bits->length = new_capacity;
+        // The last word may be kept partially
+        if (new_capacity % 64)
+            mvbits_words(new_bits)[new_capacity / 64] &=
+                ((uint64_t)1 << (new_capacity % 64)) - 1;
+    }
+    mvbits_touch(new_bits, new_bits->length);
+    return new_bits;
+}
+
+// Appends the given bit (1 if value is nonzero, 0 otherwise) to the given bit
+// vector. If it is full, doubles its capacity first. On success, returns a
+// pointer to the bit vector; its pointer's previous value may get invalidated.
+// On failure, returns NULL; the state and the data of the given bit vector
+// remain untouched.
+// UB: bits == NULL or address of not a valid bit vector
+mvbits_t* mvbits_push(mvbits_t* bits, int value) {
+    if (bits->length == bits->capacity) {
+        mvbits_t* new_bits = mvbits_resize(
+                bits,
+                bits->capacity ? bits->capacity * 2 : 64
+                );
+        if (!new_bits) return NULL;
+        bits = new_bits;
+    }
+    size_t index = bits->length++;
+    if (value) {
+        mvbits_words(bits)[index / 64] |= (uint64_t)1 << (index % 64);
+        mvbits_touch(bits, index);
+    }
+    return bits;
+}
+
+// Deallocates the given bit vector along with its rank directory.
+// UB: bits == NULL or address of not a valid bit vector
+void mvbits_free(mvbits_t* bits) {
+    if (bits->ranks) mvfree(bits->ranks);
+    mvfree(bits);
+}
+
+// Bitwise operations below process both vectors a word at a time in plain
+// loops the compiler vectorizes for the target's widest registers. They
+// modify dest and leave src untouched.
+// UB (for all of them):
+//  @ dest or src == NULL or address of not a valid bit vector
+//  @ mvbits_len(dest) != mvbits_len(src)
+
+// dest = dest & src
+void mvbits_and(mvbits_t* dest, mvbits_t* src) {
+    uint64_t* MVEC_RESTRICT d = mvbits_words(dest);
+    const uint64_t* MVEC_RESTRICT s = mvbits_words(src);
+    size_t words = mvbits_wordsFor(dest->length);
+    for (size_t i = 0; i < words; i++) d[i] &= s[i];
+    dest->rank_valid = dest->rank_valid ? 1 : 0;
+}
+
+// dest = dest | src
+void mvbits_or(mvbits_t* dest, mvbits_t* src) {
+    uint64_t* MVEC_RESTRICT d = mvbits_words(dest);
+    const uint64_t* MVEC_RESTRICT s = mvbits_words(src);
+    size_t words = mvbits_wordsFor(dest->length);
+    for (size_t i = 0; i < words; i++) d[i] |= s[i];
+    dest->rank_valid = dest->rank_valid ? 1 : 0;
+}
+
+// dest = dest ^ src
+void mvbits_xor(mvbits_t* dest, mvbits_t* src) {
+    uint64_t* MVEC_RESTRICT d = mvbits_words(dest);
+    const uint64_t* MVEC_RESTRICT s = mvbits_words(src);
+    size_t words = mvbits_wordsFor(dest->length);
+    for (size_t i = 0; i < words; i++) d[i] ^= s[i];
+    dest->rank_valid = dest->rank_valid ? 1 : 0;
+}
+
+// dest = dest & ~src
+void mvbits_andnot(mvbits_t* dest, mvbits_t* src) {
+    uint64_t* MVEC_RESTRICT d = mvbits_words(dest);
+    const uint64_t* MVEC_RESTRICT s = mvbits_words(src);
+    size_t words = mvbits_wordsFor(dest->length);
+    for (size_t i = 0; i < words; i++) d[i] &= ~s[i];
+    dest->rank_valid = dest->rank_valid ? 1 : 0;
+}
+
+// Returns the amount of set bits of the given bit vector. Uses AVX-512
+// VPOPCNTDQ or AVX2 when the target supports them.
+// UB: bits == NULL or address of not a valid bit vector
+size_t mvbits_popcount(mvbits_t* bits) {
+    return mvbits_popcountWords(
+            mvbits_words(bits),
+            mvbits_wordsFor(bits->length)
+            );
+}
+
+// Brings the rank directory of the given bit vector up to date, allocating or
+// growing it when needed [with current allocator]. Only the entries
+// invalidated since the previous call get recounted. Returns 1 on success. On
+// failure, returns 0; the directory remains outdated.
+// UB:
+//  @ bits == NULL or address of not a valid bit vector
+//  [@ current allocator is not set with mvec_setAllocator()]
+int mvbits_index(mvbits_t* bits) {
+    // One entry per superblock plus the total count
+    size_t entries = bits->length / MVBITS_SUPERBLOCK + 2;
+    if (!bits->ranks) {
+        bits->ranks = (uint64_t*)mvalloc(entries, sizeof(uint64_t));
+        if (!bits->ranks) return 0;
+        bits->ranks[0] = 0;
+        bits->rank_valid = 1;
+    } else if (mvcap(bits->ranks) < entries) {
+        mvdef uint64_t* ranks = (uint64_t*)mvresize(bits->ranks, entries * 2);
+        if (!ranks) return 0;
+        bits->ranks = ranks;
+    }
+    if (bits->rank_valid > entries) bits->rank_valid = entries;
+    const uint64_t* words = mvbits_words(bits);
+    size_t total_words = mvbits_wordsFor(bits->length);
+    const size_t block_words = MVBITS_SUPERBLOCK / 64;
+    for (size_t entry = bits->rank_valid; entry < entries; entry++) {
+        size_t first = (entry - 1) * block_words;
+        size_t quantity = first >= total_words ? 0
+            : total_words - first < block_words ? total_words - first
+            : block_words;
+        bits->ranks[entry] = bits->ranks[entry - 1]
+            + mvbits_popcountWords(words + first, quantity);
+    }
+    *mvlen(bits->ranks) = entries;
+    bits->rank_valid = entries;
+    return 1;
+}
+
+// Returns the amount of set bits before the given index of the given bit
+// vector.
+// UB:
+//  @ bits == NULL or address of not a valid bit vector
+//  @ index > mvbits_len(bits)
+//  @ the vector was modified after the last successful mvbits_index() call
+size_t mvbits_rank(mvbits_t* bits, size_t index) {
+    const uint64_t* words = mvbits_words(bits);
+    size_t word = index / 64;
+    size_t count = bits->ranks[index / MVBITS_SUPERBLOCK];
+    for (size_t i = index / MVBITS_SUPERBLOCK * (MVBITS_SUPERBLOCK / 64);
+            i < word; i++)
+        count += mvbits_popcount64(words[i]);
+    if (index % 64)
+        count += mvbits_popcount64(
+                words[word] & (((uint64_t)1 << (index % 64)) - 1)
+                );
+    return count;
+}
+
+// Returns the index of the set bit with the given rank (i.e. there are rank
+// set bits before it) of the given bit vector, or its length if there are not
+// enough set bits. Binary searches the rank directory for the superblock and
+// then counts bits word by word.
+// UB:
+//  @ bits == NULL or address of not a valid bit vector
+//  @ the vector was modified after the last successful mvbits_index() call
+size_t mvbits_select(mvbits_t* bits, size_t rank) {
+    size_t entries = *mvlen(bits->ranks);
+    if (rank >= bits->ranks[entries - 1]) return bits->length;
+    // Last superblock with less than rank + 1 set bits before it
+    size_t lo = 0;
+    size_t hi = entries - 1;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (bits->ranks[mid] <= rank) lo = mid;
+        else hi = mid;
+    }
+    rank -= bits->ranks[lo];
+    const uint64_t* words = mvbits_words(bits);
+    size_t word = lo * (MVBITS_SUPERBLOCK / 64);
+    for (;; word++) {
+        unsigned count = mvbits_popcount64(words[word]);
+        if (rank < count) break;
+        rank -= count;
+    }
+    return word * 64 + mvbits_select64(words[word], (unsigned)rank);
+}
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
+#endif // MVBITS_IMPLEMENTATION
+#endif // !MVBITS_H
@@ -27,6 +27,15 @@ SOFTWARE. */
 
 #include <stddef.h> // size_t, ptrdiff_t
 
+// The header can be used from C++ as well (see mvec.hpp). C++ has no restrict
+// keyword, so a common extension is used there instead
+#ifdef __cplusplus
+#define MVEC_RESTRICT __restrict
+extern "C" {
+#else // !__cplusplus
+#define MVEC_RESTRICT restrict
+#endif // __cplusplus
+
 // Use this typedef when the elements' type is irrelevant
 typedef void mvec_t;
 
@@ -36,30 +45,93 @@ typedef void mvec_t;
 // using it but still can improve the readability
 #define mvdef
 
+// Type for comparison function pointers used by the companion headers.
+// Semantics are the same as the ones of qsort()'s and bsearch()'s comparators
+typedef int (*cmpfunc_t)(const void*, const void*);
+
 #ifdef MVEC_CUSTOM_ALLOCATORS
 // Types for allocator function pointers
 typedef void* (*allocfunc_t)(size_t);
 typedef void* (*reallocfunc_t)(void*, size_t);
 typedef void (*freefunc_t)(void*);
+typedef void* (*callocfunc_t)(size_t, size_t);
 #endif // MVEC_CUSTOM_ALLOCATORS
 
 #ifdef MVEC_CUSTOM_MEMFUNCS
 // Types for custom memory functions
 typedef void* (*memcpyfunc_t)(
-        void* restrict dest,
-        const void* restrict src,
+        void* MVEC_RESTRICT dest,
+        const void* MVEC_RESTRICT src,
         size_t bytes
         );
 typedef void* (*memmovefunc_t)(void* dest, const void* src, size_t bytes);
 #endif // MVEC_CUSTOM_MEMFUNCS
 
-// Mvec's header differs in size depending on whether custom allocator support
-// is enabled or disabled
+// Implementations of the library and of the companion headers copy and move
+// elements with these. The current custom functions are only visible in the
+// translation unit with MVEC_IMPLEMENTATION, so companion implementations
+// must be compiled there when MVEC_CUSTOM_MEMFUNCS is defined
+#ifdef MVEC_CUSTOM_MEMFUNCS
+#define MVEC_MEMCPY_FUNCTION mvec_current_memcpy
+#define MVEC_MEMMOVE_FUNCTION mvec_current_memmove
+#else // !MVEC_CUSTOM_MEMFUNCS
+#define MVEC_MEMCPY_FUNCTION memcpy
+#define MVEC_MEMMOVE_FUNCTION memmove
+#endif // MVEC_CUSTOM_MEMFUNCS
+
+#ifdef MVEC_TRACE
+#include <stdint.h> // uint8_t, uint16_t, uint32_t, uint64_t
+
+// Amount of events buffered by each thread before they get written to the
+// trace file
+#ifndef MVEC_TRACE_BUFFER
+#define MVEC_TRACE_BUFFER 1024
+#endif // !MVEC_TRACE_BUFFER
+
+// The first bytes of every trace file
+#define MVEC_TRACE_MAGIC "MVTRACE1"
+
+typedef enum mvec_trace_type_t {
+    MVEC_TRACE_ALLOC = 1,
+    MVEC_TRACE_RESIZE,
+    MVEC_TRACE_COPY,
+    MVEC_TRACE_FREE,
+    MVEC_TRACE_FROM_NORMAL,
+    MVEC_TRACE_TO_NORMAL,
+} MvecTraceType;
+
+// A single record of a trace file. The file consists of MVEC_TRACE_MAGIC
+// followed by the records in the native byte order. Records are written in
+// per-thread batches, so sort them by timestamp to get the global order.
+// mvcopy() produces an MVEC_TRACE_ALLOC record of the copy followed by an
+// MVEC_TRACE_COPY one.
+typedef struct mvec_trace_event_t {
+    uint64_t timestamp;     // Nanoseconds, monotonic
+    uint64_t id;            // Of the vector, unique within the trace, never 0
+    uint64_t parent;        // Id of the source vector of MVEC_TRACE_COPY
+    uint64_t old_capacity;  // 0 for the vectors that are just created
+    uint64_t new_capacity;  // 0 for the vectors that are just destroyed
+    uint64_t length;        // Length before the operation (elements)
+    uint32_t element_size;
+    uint8_t type;           // MvecTraceType
+    uint8_t moved;          // Whether the chunk got a different address
+    uint16_t reserved;
+} MvecTraceEvent;
+#endif // MVEC_TRACE
+
+// Mvec's header differs in size depending on whether custom allocator support,
+// shared vectors support and tracing are enabled or disabled
 typedef struct mvec_header_t {
 #ifdef MVEC_CUSTOM_ALLOCATORS
     reallocfunc_t realloc;
     freefunc_t free;
 #endif // MVEC_CUSTOM_ALLOCATORS
+#ifdef MVEC_SHARED
+    size_t refcount;
+#endif // MVEC_SHARED
+#ifdef MVEC_TRACE
+    size_t trace_id;
+#endif // MVEC_TRACE
     size_t length;
     size_t capacity;
     size_t element_size;
@@ -69,9 +141,13 @@ typedef struct mvec_header_t {
 // descriptions
 
 mvec_t* mvalloc(size_t capacity, size_t element_size);
+mvec_t* mvcalloc(size_t capacity, size_t element_size);
+mvec_t* mvalloc_like(mvec_t* mvec, size_t capacity);
 mvec_t* mvresize(mvec_t* mvec, size_t new_capacity);
+mvec_t* mvresize_zeroed(mvec_t* mvec, size_t new_capacity);
 mvec_t* mvcopy(mvec_t* mvec, size_t new_capacity);
 void mvshift(mvec_t* mvec, size_t index, ptrdiff_t offset);
+void mvfill(mvec_t* mvec, const void* pattern);
 void mvfree(mvec_t* mvec);
 static inline size_t* mvlen(mvec_t* mvec);
 static inline size_t mvcap(mvec_t* mvec);
@@ -87,10 +163,23 @@ void* mvec_toNormal(
 
 static inline MvecHeader* mvhead(mvec_t* mvec);
 
+#ifdef MVEC_SHARED
+mvec_t* mvshare(mvec_t* mvec);
+mvec_t* mvmut(mvec_t* mvec);
+size_t mvrefs(mvec_t* mvec);
+#endif // MVEC_SHARED
+
+#ifdef MVEC_TRACE
+int mvec_traceOpen(const char* path);
+void mvec_traceFlush(void);
+void mvec_traceClose(void);
+#endif // MVEC_TRACE
+
 #ifdef MVEC_CUSTOM_ALLOCATORS
 void mvec_setAllocator(
         allocfunc_t malloc_f, reallocfunc_t realloc_f, freefunc_t free_f
         );
+void mvec_setCalloc(callocfunc_t calloc_f);
 #endif // MVEC_CUSTOM_ALLOCATORS
 
 #ifdef MVEC_CUSTOM_MEMFUNCS
@@ -131,28 +220,43 @@ static inline MvecHeader* mvhead(mvec_t* mvec) {
     return (MvecHeader*)mvec - 1;
 }
 
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
 #ifdef MVEC_IMPLEMENTATION
 #undef MVEC_IMPLEMENTATION
 
 #ifndef MVEC_CUSTOM_ALLOCATORS
-#include <stdlib.h> // malloc, realloc, free
+#include <stdlib.h> // malloc, calloc, realloc, free
 #endif // !MVEC_CUSTOM_ALLOCATORS
-
-#ifdef MVEC_CUSTOM_MEMFUNCS
-#define MVEC_MEMCPY_FUNCTION mvec_current_memcpy
-#define MVEC_MEMMOVE_FUNCTION mvec_current_memmove
-#else // !MVEC_CUSTOM_MEMFUNCS
-#include <string.h> // memcpy, memmove
-#define MVEC_MEMCPY_FUNCTION memcpy
-#define MVEC_MEMMOVE_FUNCTION memmove
-#endif // MVEC_CUSTOM_MEMFUNCS
+#include <string.h> // memset
+
+#ifdef __SSE2__
+#include <immintrin.h> // SSE2/AVX loads and stores for mvfill()
+#endif // __SSE2__
+
+#ifdef MVEC_TRACE
+#include <stdio.h> // FILE, fopen, fwrite, fclose
+#include <time.h> // clock_gettime or timespec_get
+#ifdef __cplusplus
+#define MVEC_THREAD_LOCAL thread_local
+#else // !__cplusplus
+#define MVEC_THREAD_LOCAL _Thread_local
+#endif // __cplusplus
+#endif // MVEC_TRACE
+
+#ifdef __cplusplus
+extern "C" {
+#endif // __cplusplus
 
 #ifdef MVEC_CUSTOM_ALLOCATORS
 static struct allocator {
     allocfunc_t malloc;
     reallocfunc_t realloc;
     freefunc_t free;
-} mvec_current_allocator = {0};
+    callocfunc_t calloc;
+} mvec_current_allocator = { NULL, NULL, NULL, NULL };
 
 // Set the library's current allocator. Its functions will be used in the
 // library functions that perform (re)allocating/freeing memory. Remember:
@@ -168,6 +272,19 @@ void mvec_setAllocator(
     mvec_current_allocator.malloc = malloc_f;
     mvec_current_allocator.realloc = realloc_f;
     mvec_current_allocator.free = free_f;
+    mvec_current_allocator.calloc = NULL;
+}
+
+// Set the calloc() function of the library's current allocator. It's
+// optional: without it, mvcalloc() uses the allocator's malloc() and zeroes
+// the memory itself. Call it after mvec_setAllocator() since the latter resets
+// it. Passing NULL removes it.
+// UB:
+//  @ calloc_f is not NULL yet still invalid function pointer
+//  @ calloc_f refers to another allocator than the current one
+//  @ function's semantic is not the same as the one of stdlib's calloc()
+void mvec_setCalloc(callocfunc_t calloc_f) {
+    mvec_current_allocator.calloc = calloc_f;
 }
 #endif // MVEC_CUSTOM_ALLOCATORS
 
@@ -192,6 +309,121 @@ void mvec_setMemmove(memmovefunc_t memmove_f) {
 }
 #endif // MVEC_CUSTOM_MEMFUNCS
 
+#ifdef MVEC_TRACE
+static FILE* mvec_trace_file = NULL;
+static char mvec_trace_lock = 0;
+static uint64_t mvec_trace_next_id = 1;
+static uint64_t mvec_trace_generation = 0; // Of the open trace file
+static MVEC_THREAD_LOCAL struct {
+    size_t count;
+    uint64_t generation; // Of the trace file the buffered events belong to
+    MvecTraceEvent events[MVEC_TRACE_BUFFER];
+} mvec_trace_buffer;
+
+static inline int mvec_traceActive(void) {
+    return __atomic_load_n(&mvec_trace_file, __ATOMIC_ACQUIRE) != NULL;
+}
+
+static uint64_t mvec_traceNow(void) {
+    struct timespec ts;
+#ifdef CLOCK_MONOTONIC
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#else // !CLOCK_MONOTONIC
+    timespec_get(&ts, TIME_UTC);
+#endif // CLOCK_MONOTONIC
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Returns an id for a vector being created. Vectors created while no trace
+// file is open get id 0 and are never recorded.
+static uint64_t mvec_traceNewId(void) {
+    if (!mvec_traceActive()) return 0;
+    return __atomic_fetch_add(&mvec_trace_next_id, 1, __ATOMIC_RELAXED);
+}
+
+static void mvec_traceRecord(
+        MvecTraceType type, uint64_t id, uint64_t parent,
+        size_t old_capacity, size_t new_capacity, size_t length,
+        size_t element_size, int moved
+        )
+{
+    if (!id || !mvec_traceActive()) return;
+    // Events left over from a previous trace file are dropped
+    uint64_t generation =
+        __atomic_load_n(&mvec_trace_generation, __ATOMIC_ACQUIRE);
+    if (mvec_trace_buffer.generation != generation) {
+        mvec_trace_buffer.generation = generation;
+        mvec_trace_buffer.count = 0;
+    }
+    MvecTraceEvent* event =
+        &mvec_trace_buffer.events[mvec_trace_buffer.count++];
+    event->timestamp = mvec_traceNow();
+    event->id = id;
+    event->parent = parent;
+    event->old_capacity = old_capacity;
+    event->new_capacity = new_capacity;
+    event->length = length;
+    event->element_size = (uint32_t)element_size;
+    event->type = (uint8_t)type;
+    event->moved = (uint8_t)(moved != 0);
+    event->reserved = 0;
+    if (mvec_trace_buffer.count == MVEC_TRACE_BUFFER) mvec_traceFlush();
+}
+
+// Starts recording the events of the library's functions into a newly
+// created (or truncated) file at the given path. Only the vectors allocated
+// after this call are traced. If a trace file is already open, it gets closed
+// first. Returns 1 on success. On failure, returns 0; nothing is recorded.
+// UB: path == NULL or not a valid null-terminated string
+int mvec_traceOpen(const char* path) {
+    mvec_traceClose();
+    FILE* file = fopen(path, "wb");
+    if (!file) return 0;
+    if (fwrite(MVEC_TRACE_MAGIC, 1, 8, file) != 8) {
+        fclose(file);
+        return 0;
+    }
+    while (__atomic_test_and_set(&mvec_trace_lock, __ATOMIC_ACQUIRE));
+    __atomic_store_n(
+            &mvec_trace_generation, mvec_trace_generation + 1,
+            __ATOMIC_RELEASE
+            );
+    __atomic_store_n(&mvec_trace_file, file, __ATOMIC_RELEASE);
+    __atomic_clear(&mvec_trace_lock, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// Writes the events buffered by the calling thread to the trace file. Every
+// thread that used traced vectors must call it before exiting, otherwise its
+// last events are lost. Does nothing if no trace file is open.
+void mvec_traceFlush(void) {
+    while (__atomic_test_and_set(&mvec_trace_lock, __ATOMIC_ACQUIRE));
+    if (mvec_trace_file && mvec_trace_buffer.count
+            && mvec_trace_buffer.generation == mvec_trace_generation)
+        fwrite(
+            mvec_trace_buffer.events,
+            sizeof(MvecTraceEvent),
+            mvec_trace_buffer.count,
+            mvec_trace_file
+            );
+    __atomic_clear(&mvec_trace_lock, __ATOMIC_RELEASE);
+    mvec_trace_buffer.count = 0;
+}
+
+// Flushes the events of the calling thread and closes the trace file. The
+// events still buffered by other threads are never written: neither by their
+// later mvec_traceFlush() calls nor into the next trace file. Does nothing if
+// no trace file is open.
+void mvec_traceClose(void) {
+    mvec_traceFlush();
+    while (__atomic_test_and_set(&mvec_trace_lock, __ATOMIC_ACQUIRE));
+    FILE* file = mvec_trace_file;
+    __atomic_store_n(&mvec_trace_file, NULL, __ATOMIC_RELEASE);
+    __atomic_clear(&mvec_trace_lock, __ATOMIC_RELEASE);
+    if (file) fclose(file);
+}
+#endif // MVEC_TRACE
+
 static inline mvec_t* mvec_fromHeader(MvecHeader* mvec_header) {
     return mvec_header + 1;
 }
@@ -205,7 +437,7 @@ static inline mvec_t* mvec_fromHeader(MvecHeader* mvec_header) {
 //  @ accessing vector's contents beyond its capacity
 //  [@ current allocator is not set with mvec_setAllocator()]
 mvec_t* mvalloc(size_t capacity, size_t element_size) {
-    MvecHeader* head =
+    MvecHeader* head = (MvecHeader*)
 #ifdef MVEC_CUSTOM_ALLOCATORS
         mvec_current_allocator.
 #endif // MVEC_CUSTOM_ALLOCATORS
@@ -216,6 +448,108 @@ mvec_t* mvalloc(size_t capacity, size_t element_size) {
     mvhead(mvec)->realloc = mvec_current_allocator.realloc;
     mvhead(mvec)->free = mvec_current_allocator.free;
 #endif // MVEC_CUSTOM_ALLOCATORS
+#ifdef MVEC_SHARED
+    mvhead(mvec)->refcount = 1;
+#endif // MVEC_SHARED
+#ifdef MVEC_TRACE
+    mvhead(mvec)->trace_id = mvec_traceNewId();
+    mvec_traceRecord(
+            MVEC_TRACE_ALLOC, mvhead(mvec)->trace_id, 0,
+            0, capacity, 0, element_size, 0
+            );
+#endif // MVEC_TRACE
+    *mvlen(mvec) = 0;
+    mvhead(mvec)->capacity = capacity;
+    mvhead(mvec)->element_size = element_size;
+    return mvec;
+}
+
+// Allocates a new empty mvec with given capacity of elements of the same size
+// as the ones of the given mvec [using the allocator stored in it rather than
+// the current one]. The new vector is a separate one: it gets its own
+// reference counter and trace id. On success, returns a pointer to newly
+// allocated mvec. On failure, returns NULL.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ reading from returned vector's contents before initialization
+//  @ accessing vector's contents beyond its capacity
+mvec_t* mvalloc_like(mvec_t* mvec, size_t capacity) {
+    size_t element_size = mvelsz(mvec);
+#ifdef MVEC_CUSTOM_ALLOCATORS
+    // realloc(NULL, n) has the semantics of malloc(n)
+    MvecHeader* head = (MvecHeader*)mvhead(mvec)->realloc(
+            NULL, sizeof(MvecHeader) + capacity * element_size
+            );
+#else // !MVEC_CUSTOM_ALLOCATORS
+    MvecHeader* head = (MvecHeader*)malloc(
+            sizeof(MvecHeader) + capacity * element_size
+            );
+#endif // MVEC_CUSTOM_ALLOCATORS
+    if (!head) return NULL;
+    mvec_t* new_mvec = mvec_fromHeader(head);
+#ifdef MVEC_CUSTOM_ALLOCATORS
+    mvhead(new_mvec)->realloc = mvhead(mvec)->realloc;
+    mvhead(new_mvec)->free = mvhead(mvec)->free;
+#endif // MVEC_CUSTOM_ALLOCATORS
+#ifdef MVEC_SHARED
+    mvhead(new_mvec)->refcount = 1;
+#endif // MVEC_SHARED
+#ifdef MVEC_TRACE
+    mvhead(new_mvec)->trace_id = mvec_traceNewId();
+    mvec_traceRecord(
+            MVEC_TRACE_ALLOC, mvhead(new_mvec)->trace_id, 0,
+            0, capacity, 0, element_size, 0
+            );
+#endif // MVEC_TRACE
+    *mvlen(new_mvec) = 0;
+    mvhead(new_mvec)->capacity = capacity;
+    mvhead(new_mvec)->element_size = element_size;
+    return new_mvec;
+}
+
+// Allocates a new mvec the same way as mvalloc() does except all of its
+// elements up to the capacity are zeroed out. Uses calloc() [of current
+// allocator if it's set with mvec_setCalloc(), otherwise uses malloc() and
+// zeroes the memory], so large vectors usually get fresh zero pages from the
+// system without touching them. On success, returns a pointer to newly
+// allocated mvec. On failure, returns NULL.
+// UB:
+//  @ accessing vector's contents beyond its capacity
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvec_t* mvcalloc(size_t capacity, size_t element_size) {
+#ifdef MVEC_CUSTOM_ALLOCATORS
+    MvecHeader* head;
+    if (mvec_current_allocator.calloc) {
+        head = (MvecHeader*)mvec_current_allocator.calloc(
+                1, sizeof(MvecHeader) + capacity * element_size
+                );
+    } else {
+        head = (MvecHeader*)mvec_current_allocator.malloc(
+                sizeof(MvecHeader) + capacity * element_size
+                );
+        if (head) memset(head + 1, 0, capacity * element_size);
+    }
+#else // !MVEC_CUSTOM_ALLOCATORS
+    MvecHeader* head = (MvecHeader*)calloc(
+            1, sizeof(MvecHeader) + capacity * element_size
+            );
+#endif // MVEC_CUSTOM_ALLOCATORS
+    if (!head) return NULL;
+    mvec_t* mvec = mvec_fromHeader(head);
+#ifdef MVEC_CUSTOM_ALLOCATORS
+    mvhead(mvec)->realloc = mvec_current_allocator.realloc;
+    mvhead(mvec)->free = mvec_current_allocator.free;
+#endif // MVEC_CUSTOM_ALLOCATORS
+#ifdef MVEC_SHARED
+    mvhead(mvec)->refcount = 1;
+#endif // MVEC_SHARED
+#ifdef MVEC_TRACE
+    mvhead(mvec)->trace_id = mvec_traceNewId();
+    mvec_traceRecord(
+            MVEC_TRACE_ALLOC, mvhead(mvec)->trace_id, 0,
+            0, capacity, 0, element_size, 0
+            );
+#endif // MVEC_TRACE
     *mvlen(mvec) = 0;
     mvhead(mvec)->capacity = capacity;
     mvhead(mvec)->element_size = element_size;
@@ -227,9 +561,15 @@ mvec_t* mvalloc(size_t capacity, size_t element_size) {
 // to it and all the trimmed data is lost. On success, returns a pointer to
 // reallocated mvec; its pointer's previous value gets invalidated. On failure,
 // returns NULL; the state and the data of the given mvec remains untouched.
-// UB: mvec == NULL or address of not a valid mvector
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  {@ mvec is shared, i.e. mvrefs(mvec) > 1. Call mvmut() first}
 mvec_t* mvresize(mvec_t* mvec, size_t new_capacity) {
-    MvecHeader* new_head =
+#ifdef MVEC_TRACE
+    uintptr_t old_address = (uintptr_t)mvec;
+    size_t old_capacity = mvcap(mvec);
+#endif // MVEC_TRACE
+    MvecHeader* new_head = (MvecHeader*)
 #ifdef MVEC_CUSTOM_ALLOCATORS
         mvhead(mvec)->
 #endif // MVEC_CUSTOM_ALLOCATORS
@@ -239,11 +579,37 @@ mvec_t* mvresize(mvec_t* mvec, size_t new_capacity) {
             );
     if (!new_head) return NULL;
     mvec_t* new_mvec = mvec_fromHeader(new_head);
+#ifdef MVEC_TRACE
+    mvec_traceRecord(
+            MVEC_TRACE_RESIZE, mvhead(new_mvec)->trace_id, 0,
+            old_capacity, new_capacity, *mvlen(new_mvec), mvelsz(new_mvec),
+            (uintptr_t)new_mvec != old_address
+            );
+#endif // MVEC_TRACE
     mvhead(new_mvec)->capacity = new_capacity;
     if (*mvlen(new_mvec) > new_capacity) *mvlen(new_mvec) = new_capacity;
     return new_mvec;
 }
 
+// Works the same way as mvresize() does, but when the capacity grows, zeroes
+// out the added elements, i.e. the ones from the old capacity till the new
+// one. The elements below the old capacity are left as they are.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  {@ mvec is shared, i.e. mvrefs(mvec) > 1. Call mvmut() first}
+mvec_t* mvresize_zeroed(mvec_t* mvec, size_t new_capacity) {
+    size_t old_capacity = mvcap(mvec);
+    mvec_t* new_mvec = mvresize(mvec, new_capacity);
+    if (!new_mvec) return NULL;
+    if (new_capacity > old_capacity)
+        memset(
+                (char*)new_mvec + old_capacity * mvelsz(new_mvec),
+                0,
+                (new_capacity - old_capacity) * mvelsz(new_mvec)
+              );
+    return new_mvec;
+}
+
 // Allocates a new vector [using current allocator] with given new_capacity and
 // copies elements from a given mvec [using current memcpy() function]. If
 // given mvec's length exceeds new_capacity, it gets leveled to it in a new
@@ -261,6 +627,13 @@ mvec_t* mvcopy(mvec_t* mvec, size_t new_capacity) {
         ? new_capacity : *mvlen(mvec);
     *mvlen(new_mvec) = new_mv_len;
     MVEC_MEMCPY_FUNCTION(new_mvec, mvec, new_mv_len * mvelsz(mvec));
+#ifdef MVEC_TRACE
+    mvec_traceRecord(
+            MVEC_TRACE_COPY, mvhead(new_mvec)->trace_id, mvhead(mvec)->trace_id,
+            mvcap(mvec), new_capacity, new_mv_len, mvelsz(mvec), 1
+            );
+#endif // MVEC_TRACE
+    return new_mvec;
 }
 
 // Shifts all the elements of the given mvec starting from the given index
@@ -289,13 +662,73 @@ void mvshift(mvec_t* mvec, size_t index, ptrdiff_t offset) {
     *mvlen(mvec) += offset;
 }
 
+// Size of the block that mvfill() broadcasts with vector stores
+#define MVEC_FILL_BLOCK 32
+
+// Sets every element of the given mvec up to its capacity to the value
+// addressed by pattern, which must be mvelsz(mvec) bytes long. Doesn't change
+// the length. Element sizes dividing MVEC_FILL_BLOCK are broadcast with
+// SSE2/AVX stores when the target supports them, the other ones get copied
+// with exponentially growing chunks [using current memcpy()].
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ pattern is not a valid pointer to mvelsz(mvec) bytes
+//  @ pattern points inside of the given mvec
+//  [@ current memcpy() function is not set with mvec_setMemcpy()]
+void mvfill(mvec_t* mvec, const void* pattern) {
+    size_t element_size = mvelsz(mvec);
+    size_t bytes = mvcap(mvec) * element_size;
+    char* dest = (char*)mvec;
+    if (!bytes) return;
+#ifdef __SSE2__
+    if (MVEC_FILL_BLOCK % element_size == 0 && bytes >= MVEC_FILL_BLOCK) {
+        char block[MVEC_FILL_BLOCK];
+        for (size_t i = 0; i < MVEC_FILL_BLOCK; i += element_size)
+            MVEC_MEMCPY_FUNCTION(block + i, pattern, element_size);
+        size_t i = 0;
+#ifdef __AVX__
+        __m256i v = _mm256_loadu_si256((const __m256i*)block);
+        for (; i + MVEC_FILL_BLOCK <= bytes; i += MVEC_FILL_BLOCK)
+            _mm256_storeu_si256((__m256i*)(dest + i), v);
+#else // !__AVX__
+        __m128i lo = _mm_loadu_si128((const __m128i*)block);
+        __m128i hi = _mm_loadu_si128((const __m128i*)(block + 16));
+        for (; i + MVEC_FILL_BLOCK <= bytes; i += MVEC_FILL_BLOCK) {
+            _mm_storeu_si128((__m128i*)(dest + i), lo);
+            _mm_storeu_si128((__m128i*)(dest + i + 16), hi);
+        }
+#endif // __AVX__
+        MVEC_MEMCPY_FUNCTION(dest + i, block, bytes - i);
+        return;
+    }
+#endif // __SSE2__
+    MVEC_MEMCPY_FUNCTION(dest, pattern, element_size);
+    for (size_t filled = element_size; filled < bytes;) {
+        size_t chunk = filled < bytes - filled ? filled : bytes - filled;
+        MVEC_MEMCPY_FUNCTION(dest + filled, dest, chunk);
+        filled += chunk;
+    }
+}
+
 // Deallocates given mvec [with the free() function pointer stored in the
-// mvec's header]. Note that you cannot use [your allocator's] free() function
-// directly on the mvector since when you allocate it you don't get the pointer
-// to the physical head of the structure but rather pointer to the first
-// element (i.e. physical head + sizeof(MvecHeader)).
+// mvec's header]. {If mvec is shared, only drops a reference to it; the memory
+// is released by the call that drops the last one.} Note that you cannot use
+// [your allocator's] free() function directly on the mvector since when you
+// allocate it you don't get the pointer to the physical head of the structure
+// but rather pointer to the first element (i.e. physical head +
+// sizeof(MvecHeader)).
 // UB: mvec == NULL or address of not a valid mvector
 void mvfree(mvec_t* mvec) {
+#ifdef MVEC_SHARED
+    if (__atomic_fetch_sub(&mvhead(mvec)->refcount, 1, __ATOMIC_ACQ_REL) > 1)
+        return;
+#endif // MVEC_SHARED
+#ifdef MVEC_TRACE
+    mvec_traceRecord(
+            MVEC_TRACE_FREE, mvhead(mvec)->trace_id, 0,
+            mvcap(mvec), 0, *mvlen(mvec), mvelsz(mvec), 0
+            );
+#endif // MVEC_TRACE
 #ifdef MVEC_CUSTOM_ALLOCATORS
     mvhead(mvec)->
 #endif // MVEC_CUSTOM_ALLOCATORS
@@ -317,6 +750,9 @@ void mvfree(mvec_t* mvec) {
 // element_size for mvalloc() except both mvec's length and capacity are set to
 // given quantity.
 mvec_t* mvec_fromNormal(void* data, size_t quantity, size_t element_size) {
+#ifdef MVEC_TRACE
+    uintptr_t old_address = (uintptr_t)data;
+#endif // MVEC_TRACE
     void* head =
 #ifdef MVEC_CUSTOM_ALLOCATORS
         mvec_current_allocator.
@@ -332,6 +768,17 @@ mvec_t* mvec_fromNormal(void* data, size_t quantity, size_t element_size) {
     mvhead(mvec)->realloc = mvec_current_allocator.realloc;
     mvhead(mvec)->free = mvec_current_allocator.free;
 #endif // MVEC_CUSTOM_ALLOCATORS
+#ifdef MVEC_SHARED
+    mvhead(mvec)->refcount = 1;
+#endif // MVEC_SHARED
+#ifdef MVEC_TRACE
+    mvhead(mvec)->trace_id = mvec_traceNewId();
+    mvec_traceRecord(
+            MVEC_TRACE_FROM_NORMAL, mvhead(mvec)->trace_id, 0,
+            0, quantity, quantity, element_size,
+            (uintptr_t)head != old_address
+            );
+#endif // MVEC_TRACE
     *mvlen(mvec) = quantity;
     mvhead(mvec)->capacity = quantity;
     mvhead(mvec)->element_size = element_size;
@@ -347,6 +794,7 @@ mvec_t* mvec_fromNormal(void* data, size_t quantity, size_t element_size) {
 // changes of mvec to the state before calling the function.
 // UB:
 //  @ mvec == NULL or address of not a valid mvector
+//  {@ mvec is shared, i.e. mvrefs(mvec) > 1. Call mvmut() first}
 //  @ quantity_out is not NULL yet still invalid
 //  @ element_size_out is not NULL yet still invalid
 //  [@ current memmove() function is not set with mvec_setMemmove()]
@@ -362,6 +810,9 @@ void* mvec_toNormal(
             mvec,
             *mvlen(mvec) * mvelsz(mvec)
             );
+#ifdef MVEC_TRACE
+    uintptr_t old_address = (uintptr_t)mvec_shifted;
+#endif // MVEC_TRACE
     void* out =
 #ifdef MVEC_CUSTOM_ALLOCATORS
         header_backup.
@@ -379,10 +830,60 @@ void* mvec_toNormal(
         *mvhead(mvec) = header_backup;
         return NULL;
     }
+#ifdef MVEC_TRACE
+    mvec_traceRecord(
+            MVEC_TRACE_TO_NORMAL, header_backup.trace_id, 0,
+            header_backup.capacity, header_backup.length, header_backup.length,
+            header_backup.element_size, (uintptr_t)out != old_address
+            );
+#endif // MVEC_TRACE
     if (quantity_out) *quantity_out = header_backup.length;
     if (element_size_out) *element_size_out = header_backup.element_size;
     return out;
 }
 
+#ifdef MVEC_SHARED
+// Takes another reference to the given mvec and returns it. It's a cheap
+// read-only snapshot: no memory gets allocated or copied. Every reference is
+// released with mvfree(). Before writing to a vector that may be shared, get
+// its private copy with mvmut(). Can be called from different threads on the
+// same mvec simultaneously.
+// UB: mvec == NULL or address of not a valid mvector
+mvec_t* mvshare(mvec_t* mvec) {
+    __atomic_fetch_add(&mvhead(mvec)->refcount, 1, __ATOMIC_RELAXED);
+    return mvec;
+}
+
+// Makes the given mvec safe to write to. If the caller holds the only
+// reference, returns mvec itself. Otherwise copies it with mvcopy() keeping
+// its capacity, drops the caller's reference to the shared one and returns
+// the copy. On failure, returns NULL; the caller's reference to the given
+// mvec remains valid.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ the given reference was already released with mvfree()
+//  [@ current allocator is not set with mvec_setAllocator()]
+//  [@ current memcpy() function is not set with mvec_setMemcpy()]
+mvec_t* mvmut(mvec_t* mvec) {
+    if (__atomic_load_n(&mvhead(mvec)->refcount, __ATOMIC_ACQUIRE) == 1)
+        return mvec;
+    mvec_t* new_mvec = mvcopy(mvec, mvcap(mvec));
+    if (!new_mvec) return NULL;
+    mvfree(mvec);
+    return new_mvec;
+}
+
+// Returns the amount of references to the given mvec. The value may be
+// already outdated if other threads share or free the vector.
+// UB: mvec == NULL or address of not a valid mvector
+size_t mvrefs(mvec_t* mvec) {
+    return __atomic_load_n(&mvhead(mvec)->refcount, __ATOMIC_ACQUIRE);
+}
+#endif // MVEC_SHARED
+
+#ifdef __cplusplus
+} // extern "C"
+#endif // __cplusplus
+
 #endif // MVEC_IMPLEMENTATION
 #endif // !MVEC_H
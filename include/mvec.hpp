@@ -0,0 +1,395 @@
+// mvec.hpp - C++ wrapper for monolithic vectors
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVEC_HPP
+#define MVEC_HPP
+
+#include <cstddef> // std::size_t, std::ptrdiff_t, std::max_align_t
+#include <initializer_list> // std::initializer_list
+#include <iterator> // std::reverse_iterator
+#include <memory> // std::uninitialized_*, std::destroy
+#include <new> // std::bad_alloc
+#include <stdexcept> // std::out_of_range
+#include <type_traits> // std::is_trivially_*
+#include <utility> // std::move, std::forward, std::move_if_noexcept
+
+#include "mvec.h"
+
+namespace mv {
+
+// Tells whether moving an object of type T to another address and forgetting
+// the old one is the same as copying its bytes. Such elements grow with a
+// single mvresize(), which can extend the memory chunk in place or let the
+// allocator move it without touching the elements. Other elements get
+// move-constructed one by one into a new chunk. Defaults to trivially copyable
+// types; specialize it for types known to be safe, e.g.:
+//  template <> struct mv::is_trivially_relocatable<MyHandle>
+//      : std::true_type {};
+// Most std::string implementations are NOT trivially relocatable.
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+// Owning vector of T over the monolithic layout of mvec.h: the object itself
+// is just a pointer to the first element, the same pointer the C functions
+// take, so it can be passed to them with data() and get(). Elements are
+// stored the same way an mvec created with mvalloc(capacity, sizeof(T))
+// stores them. All the (re)allocations go through mvec.h [with the allocator
+// stored in the vector's header, the current one for vectors yet to be
+// allocated]. Moving a vector only moves the pointer. Iterators are plain
+// pointers, so they are contiguous and work with <algorithm> and the
+// parallel execution policies.
+template <typename T>
+class mvec {
+    static_assert(
+            alignof(T) <= alignof(std::max_align_t)
+                && sizeof(MvecHeader) % alignof(T) == 0,
+            "mvec elements follow MvecHeader and must not be overaligned"
+            );
+
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = T&;
+    using const_reference = const T&;
+    using pointer = T*;
+    using const_pointer = const T*;
+    using iterator = T*;
+    using const_iterator = const T*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    mvec() noexcept = default;
+
+    mvec(std::initializer_list<T> init) {
+        if (!init.size()) return;
+        copy_from(init.begin(), init.size());
+    }
+
+    mvec(const mvec& other) {
+        if (other.empty()) return;
+        if constexpr (std::is_trivially_copyable_v<T>) {
+            data_ = static_cast<T*>(mvcopy(other.data_, other.size()));
+            if (!data_) throw std::bad_alloc();
+        } else {
+            copy_from(other.begin(), other.size());
+        }
+    }
+
+    mvec(mvec&& other) noexcept : data_(other.data_) {
+        other.data_ = nullptr;
+    }
+
+    ~mvec() {
+        reset();
+    }
+
+    mvec& operator=(const mvec& other) {
+        if (this != &other) mvec(other).swap(*this);
+        return *this;
+    }
+
+    mvec& operator=(mvec&& other) noexcept {
+        if (this != &other) {
+            reset();
+            data_ = other.data_;
+            other.data_ = nullptr;
+        }
+        return *this;
+    }
+
+    // Takes ownership of an mvec allocated by the C functions with
+    // element_size == sizeof(T). Its elements must be valid objects
+    static mvec adopt(T* raw) noexcept {
+        mvec result;
+        result.data_ = raw;
+        return result;
+    }
+
+    // Gives up ownership of the underlying mvec, which may be NULL if nothing
+    // was ever allocated. Release it with mvfree() after destroying elements
+    T* release() noexcept {
+        T* raw = data_;
+        data_ = nullptr;
+        return raw;
+    }
+
+    mvec_t* get() const noexcept { return data_; }
+    T* data() noexcept { return data_; }
+    const T* data() const noexcept { return data_; }
+
+    size_type size() const noexcept { return data_ ? *mvlen(data_) : 0; }
+    size_type capacity() const noexcept { return data_ ? mvcap(data_) : 0; }
+    bool empty() const noexcept { return size() == 0; }
+
+    T& operator[](size_type i) noexcept { return data_[i]; }
+    const T& operator[](size_type i) const noexcept { return data_[i]; }
+
+    T& at(size_type i) {
+        if (i >= size()) throw std::out_of_range("mv::mvec::at");
+        return data_[i];
+    }
+
+    const T& at(size_type i) const {
+        if (i >= size()) throw std::out_of_range("mv::mvec::at");
+        return data_[i];
+    }
+
+    T& front() noexcept { return data_[0]; }
+    const T& front() const noexcept { return data_[0]; }
+    T& back() noexcept { return data_[size() - 1]; }
+    const T& back() const noexcept { return data_[size() - 1]; }
+
+    iterator begin() noexcept { return data_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator cbegin() const noexcept { return data_; }
+    iterator end() noexcept { return data_ + size(); }
+    const_iterator end() const noexcept { return data_ + size(); }
+    const_iterator cend() const noexcept { return data_ + size(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    // Makes room for at least new_capacity elements. Never shrinks
+    void reserve(size_type new_capacity) {
+        if (new_capacity > capacity()) reallocate(new_capacity);
+    }
+
+    // Trims capacity to the size. Frees the vector if it is empty
+    void shrink_to_fit() {
+        if (empty()) reset();
+        else if (size() < capacity()) reallocate(size());
+    }
+
+    // The arguments may refer to elements of the vector, e.g.
+    // v.push_back(v[0]), so when it's full the new element is built before
+    // growing frees them
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size() == capacity()) {
+            T value(std::forward<Args>(args)...);
+            grow(size() + 1);
+            return construct_back(std::move(value));
+        }
+        return construct_back(std::forward<Args>(args)...);
+    }
+
+    void push_back(const T& value) { emplace_back(value); }
+    void push_back(T&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() noexcept {
+        *mvlen(data_) -= 1;
+        data_[size()].~T();
+    }
+
+    void clear() noexcept {
+        if (!data_) return;
+        std::destroy(begin(), end());
+        *mvlen(data_) = 0;
+    }
+
+    void resize(size_type new_size) {
+        resize_with(new_size, [](T* slot) {
+                ::new (static_cast<void*>(slot)) T();
+                });
+    }
+
+    // Copies value before growing, since it may be an element of the vector
+    void resize(size_type new_size, const T& value) {
+        if (new_size <= capacity()) {
+            resize_with(new_size, [&value](T* slot) {
+                    ::new (static_cast<void*>(slot)) T(value);
+                    });
+            return;
+        }
+        T copy(value);
+        resize_with(new_size, [&copy](T* slot) {
+                ::new (static_cast<void*>(slot)) T(copy);
+                });
+    }
+
+    // Inserts value before pos. Trivially relocatable elements are shifted
+    // with mvshift(), the others are moved one by one
+    iterator insert(const_iterator pos, T value) {
+        size_type index = static_cast<size_type>(pos - begin());
+        if (size() == capacity()) grow(size() + 1);
+        size_type length = size();
+        if (index == length) {
+            emplace_back(std::move(value));
+            return data_ + index;
+        }
+        if constexpr (is_trivially_relocatable<T>::value) {
+            mvshift(data_, index, +1);
+            ::new (static_cast<void*>(data_ + index)) T(std::move(value));
+        } else {
+            ::new (static_cast<void*>(data_ + length))
+                T(std::move(data_[length - 1]));
+            *mvlen(data_) += 1;
+            for (size_type i = length - 1; i > index; i--)
+                data_[i] = std::move(data_[i - 1]);
+            data_[index] = std::move(value);
+        }
+        return data_ + index;
+    }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        size_type index = static_cast<size_type>(first - begin());
+        size_type count = static_cast<size_type>(last - first);
+        if (!count) return data_ + index;
+        size_type length = size();
+        if constexpr (is_trivially_relocatable<T>::value) {
+            std::destroy(data_ + index, data_ + index + count);
+            if (index + count < length)
+                mvshift(data_, index + count,
+                        -static_cast<difference_type>(count));
+            else
+                *mvlen(data_) = index;
+        } else {
+            T* tail = std::move(data_ + index + count, data_ + length,
+                    data_ + index);
+            std::destroy(tail, data_ + length);
+            *mvlen(data_) = length - count;
+        }
+        return data_ + index;
+    }
+
+    void swap(mvec& other) noexcept {
+        T* tmp = data_;
+        data_ = other.data_;
+        other.data_ = tmp;
+    }
+
+private:
+    T* data_ = nullptr;
+
+    void reset() noexcept {
+        if (!data_) return;
+        clear();
+        mvfree(data_);
+        data_ = nullptr;
+    }
+
+    // Fills an empty vector with copies of count elements. Constructors can't
+    // rely on the destructor, so a throwing copy frees the chunk here
+    void copy_from(const T* first, size_type count) {
+        reserve(count);
+        try {
+            std::uninitialized_copy(first, first + count, data_);
+        } catch (...) {
+            mvfree(data_);
+            data_ = nullptr;
+            throw;
+        }
+        *mvlen(data_) = count;
+    }
+
+    // Constructs an element past the end. There must be room for it
+    template <typename... Args>
+    T& construct_back(Args&&... args) {
+        T* slot = data_ + size();
+        ::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+        *mvlen(data_) += 1;
+        return *slot;
+    }
+
+    // Doubles the capacity or grows it to the required one, whichever is more
+    void grow(size_type required) {
+        size_type doubled = capacity() * 2;
+        reallocate(doubled > required ? doubled : required);
+    }
+
+    // Allocates an empty mvec for new_capacity elements. An existing vector
+    // [passes its own allocator on]
+    T* allocate(size_type new_capacity) {
+        T* fresh = static_cast<T*>(data_
+                ? mvalloc_like(data_, new_capacity)
+                : mvalloc(new_capacity, sizeof(T)));
+        if (!fresh) throw std::bad_alloc();
+        return fresh;
+    }
+
+    // Trivially relocatable elements ride along with mvresize(). The others
+    // are moved (or copied, if their move may throw) into a new chunk, so a
+    // throwing constructor leaves the vector untouched
+    void reallocate(size_type new_capacity) {
+        if (!data_) {
+            data_ = allocate(new_capacity);
+            return;
+        }
+        if constexpr (is_trivially_relocatable<T>::value) {
+            mvec_t* resized = mvresize(data_, new_capacity);
+            if (!resized) throw std::bad_alloc();
+            data_ = static_cast<T*>(resized);
+        } else {
+            T* fresh = allocate(new_capacity);
+            size_type length = size();
+            size_type moved = 0;
+            try {
+                for (; moved < length; moved++)
+                    ::new (static_cast<void*>(fresh + moved))
+                        T(std::move_if_noexcept(data_[moved]));
+            } catch (...) {
+                std::destroy(fresh, fresh + moved);
+                mvfree(fresh);
+                throw;
+            }
+            *mvlen(fresh) = length;
+            reset();
+            data_ = fresh;
+        }
+    }
+
+    template <typename Construct>
+    void resize_with(size_type new_size, Construct construct) {
+        size_type length = size();
+        if (new_size <= length) {
+            if (data_) {
+                std::destroy(data_ + new_size, data_ + length);
+                *mvlen(data_) = new_size;
+            }
+            return;
+        }
+        reserve(new_size);
+        for (; length < new_size; length++) {
+            construct(data_ + length);
+            *mvlen(data_) = length + 1;
+        }
+    }
+};
+
+template <typename T>
+void swap(mvec<T>& a, mvec<T>& b) noexcept {
+    a.swap(b);
+}
+
+} // namespace mv
+
+#endif // !MVEC_HPP
@@ -0,0 +1,236 @@
+// mvgrow.h - Monolithic vectors growing without stalls
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVGROW_H
+#define MVGROW_H
+
+#include "mvec.h"
+
+// A vector that doesn't copy all of its elements at once when it grows.
+// Instead, it allocates a new mvec twice as large and keeps the old one until
+// all the elements are migrated to the new one, at most step elements per
+// push or access. Elements [0, migrated) and [old_length, length) are in the
+// current mvec, elements [migrated, old_length) are still in the old one.
+// Freeing a large block may stall as long as copying it, so the old mvec is
+// kept after the migration until mvgrow_finish() or the next growth
+typedef struct mvgrow_header_t {
+    mvdef void* current;
+    mvdef void* old; // NULL if there's nothing to migrate or free
+    size_t migrated;
+    size_t old_length;
+    size_t step;
+} MvgrowHeader;
+
+// Use this typedef for incrementally growing vectors. Release them with
+// mvgrow_free()
+typedef MvgrowHeader mvgrow_t;
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+mvgrow_t* mvgrow_alloc(
+        size_t capacity,
+        size_t element_size,
+        size_t step_bytes
+        );
+void mvgrow_free(mvgrow_t* grow);
+int mvgrow_push(mvgrow_t* grow, const void* value);
+void mvgrow_pop(mvgrow_t* grow);
+static inline void* mvgrow_at(mvgrow_t* grow, size_t index);
+size_t mvgrow_migrate(mvgrow_t* grow, size_t count);
+void mvgrow_finish(mvgrow_t* grow);
+mvec_t* mvgrow_release(mvgrow_t* grow);
+static inline size_t mvgrow_len(mvgrow_t* grow);
+static inline size_t mvgrow_cap(mvgrow_t* grow);
+static inline size_t mvgrow_elsz(mvgrow_t* grow);
+static inline int mvgrow_migrating(mvgrow_t* grow);
+
+// Returns amount of elements of the given vector. Consider changing it via
+// mvgrow_push() and mvgrow_pop().
+// UB: grow == NULL or address of not a valid incrementally growing vector
+static inline size_t mvgrow_len(mvgrow_t* grow) {
+    return *mvlen(grow->current);
+}
+
+// Returns capacity of the given vector, i.e. the capacity of its current mvec.
+// UB: grow == NULL or address of not a valid incrementally growing vector
+static inline size_t mvgrow_cap(mvgrow_t* grow) {
+    return mvcap(grow->current);
+}
+
+// Returns size of a single element of the given vector in bytes.
+// UB: grow == NULL or address of not a valid incrementally growing vector
+static inline size_t mvgrow_elsz(mvgrow_t* grow) {
+    return mvelsz(grow->current);
+}
+
+// Returns whether the given vector still keeps some elements in the old mvec.
+// UB: grow == NULL or address of not a valid incrementally growing vector
+static inline int mvgrow_migrating(mvgrow_t* grow) {
+    return grow->old && grow->migrated < grow->old_length;
+}
+
+// Migrates the next step elements (if any are left) and returns address of
+// the element with the given index. The address stays valid until the next
+// call of any function modifying the vector, including mvgrow_at() itself.
+// UB:
+//  @ grow == NULL or address of not a valid incrementally growing vector
+//  @ index >= mvgrow_len(grow)
+static inline void* mvgrow_at(mvgrow_t* grow, size_t index) {
+    if (grow->old) {
+        mvgrow_migrate(grow, grow->step);
+        if (index >= grow->migrated && index < grow->old_length)
+            return (char*)grow->old + index * mvelsz(grow->old);
+    }
+    return (char*)grow->current + index * mvelsz(grow->current);
+}
+
+#ifdef MVGROW_IMPLEMENTATION
+#undef MVGROW_IMPLEMENTATION
+
+#include <string.h> // memcpy
+
+// Allocates a new incrementally growing vector with given capacity of elements
+// with element_size each. Sets length to 0. Every push or access copies at
+// most step_bytes of the elements being migrated (but at least one element).
+// On success, returns a pointer to the new vector. On failure, returns NULL.
+// UB:
+//  @ element_size == 0
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvgrow_t* mvgrow_alloc(
+        size_t capacity,
+        size_t element_size,
+        size_t step_bytes
+        )
+{
+    mvdef mvgrow_t* grow = mvalloc(1, sizeof(mvgrow_t));
+    if (!grow) return NULL;
+    *mvlen(grow) = 1;
+    grow->current = mvalloc(capacity, element_size);
+    if (!grow->current) {
+        mvfree(grow);
+        return NULL;
+    }
+    grow->old = NULL;
+    grow->migrated = 0;
+    grow->old_length = 0;
+    grow->step = step_bytes / element_size ? step_bytes / element_size : 1;
+    return grow;
+}
+
+// Deallocates the given vector together with both of its mvecs.
+// UB: grow == NULL or address of not a valid incrementally growing vector
+void mvgrow_free(mvgrow_t* grow) {
+    if (grow->old) mvfree(grow->old);
+    mvfree(grow->current);
+    mvfree(grow);
+}
+
+// Copies up to count of the elements left in the old mvec of the given vector
+// to the current one. Returns amount of elements left to migrate. Doesn't
+// free the old mvec, even if it's done; that's up to mvgrow_finish().
+// UB: grow == NULL or address of not a valid incrementally growing vector
+size_t mvgrow_migrate(mvgrow_t* grow, size_t count) {
+    if (!grow->old) return 0;
+    size_t left = grow->old_length - grow->migrated;
+    if (count > left) count = left;
+    size_t element_size = mvelsz(grow->current);
+    MVEC_MEMCPY_FUNCTION(
+            (char*)grow->current + grow->migrated * element_size,
+            (char*)grow->old + grow->migrated * element_size,
+            count * element_size
+          );
+    grow->migrated += count;
+    return grow->old_length - grow->migrated;
+}
+
+// Migrates all the elements left in the old mvec of the given vector, if
+// there are any, and frees the old mvec. Call it in the idle time, otherwise
+// the next growth does it.
+// UB: grow == NULL or address of not a valid incrementally growing vector
+void mvgrow_finish(mvgrow_t* grow) {
+    if (!grow->old) return;
+    mvgrow_migrate(grow, grow->old_length - grow->migrated);
+    mvfree(grow->old);
+    grow->old = NULL;
+}
+
+// Appends the value of mvgrow_elsz(grow) bytes at the given address to the
+// given vector. If it's full, allocates a new mvec twice as large and starts
+// migrating to it instead of copying everything at once. Then migrates the
+// next step elements. Returns 1 on success. On failure, returns 0; the elements
+// of the vector remain untouched.
+// UB:
+//  @ grow == NULL or address of not a valid incrementally growing vector
+//  @ value is not a valid pointer to mvgrow_elsz(grow) bytes
+//  @ value points inside the vector
+//  [@ current allocator is not set with mvec_setAllocator()]
+int mvgrow_push(mvgrow_t* grow, const void* value) {
+    size_t length = *mvlen(grow->current);
+    size_t element_size = mvelsz(grow->current);
+    if (length == mvcap(grow->current)) {
+        // Doubling leaves as many pushes as there are elements to migrate,
+        // so the previous migration is over by now, unless the step is
+        // too small; only the old mvec is left to free
+        mvgrow_finish(grow);
+        mvec_t* bigger = mvalloc(length ? length * 2 : 1, element_size);
+        if (!bigger) return 0;
+        *mvlen(bigger) = length;
+        grow->old = grow->current;
+        grow->current = bigger;
+        grow->migrated = 0;
+        grow->old_length = length;
+        if (!length) mvgrow_finish(grow);
+    }
+    MVEC_MEMCPY_FUNCTION((char*)grow->current + length * element_size, value,
+            element_size);
+    *mvlen(grow->current) = length + 1;
+    mvgrow_migrate(grow, grow->step);
+    return 1;
+}
+
+// Removes the last element of the given vector.
+// UB:
+//  @ grow == NULL or address of not a valid incrementally growing vector
+//  @ mvgrow_len(grow) == 0
+void mvgrow_pop(mvgrow_t* grow) {
+    size_t length = --*mvlen(grow->current);
+    if (grow->old && length < grow->old_length) {
+        grow->old_length = length;
+        if (grow->migrated > length) grow->migrated = length;
+    }
+}
+
+// Finishes the migration of the given vector and turns it into an ordinary
+// mvec: returns its current mvec and frees the rest.
+// UB: grow == NULL or address of not a valid incrementally growing vector
+mvec_t* mvgrow_release(mvgrow_t* grow) {
+    mvgrow_finish(grow);
+    mvec_t* mvec = grow->current;
+    mvfree(grow);
+    return mvec;
+}
+
+#endif // MVGROW_IMPLEMENTATION
+#endif // !MVGROW_H
@@ -0,0 +1,484 @@
+// mvhash.h - Open-addressing hash map in a monolithic vector
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVHASH_H
+#define MVHASH_H
+
+#include "mvec.h"
+
+// Types for hash and key comparison function pointers. A key comparator has
+// the same semantics as string.h's memcmp() (which is also the default one)
+typedef size_t (*hashfunc_t)(const void* key, size_t key_size);
+typedef int (*memcmpfunc_t)(const void* a, const void* b, size_t bytes);
+
+// A hash map lives in the data of a byte mvec, so it is allocated, resized and
+// freed by the core functions [with the allocator it was allocated with]. The
+// header is followed by one control byte per slot, then by the key slots and
+// then by the value slots:
+//
+//  | MvhashHeader | control bytes | keys | values |
+//
+// Control bytes work the way SwissTable's do: a free slot is marked with
+// MVHASH_EMPTY, a slot whose element was removed with MVHASH_DELETED and a
+// used slot with the lowest 7 bits of its key's hash. Lookups compare a whole
+// group of MVHASH_GROUP control bytes against those 7 bits at once and look at
+// the keys only on a match. The first MVHASH_GROUP control bytes are mirrored
+// after the last one, so a group starting at any slot can be loaded at once
+typedef struct mvhash_header_t {
+    size_t length;
+    size_t capacity; // in slots, a power of two
+    size_t growth_left; // insertions into empty slots before a rehash
+    size_t key_size;
+    size_t value_size;
+    size_t keys_offset; // in bytes, from the start of MvhashHeader
+    size_t values_offset;
+    hashfunc_t hash;
+    memcmpfunc_t cmp;
+} MvhashHeader;
+
+// Use this typedef for hash maps. Release them with mvfree()
+typedef MvhashHeader mvhash_t;
+
+#define MVHASH_GROUP 16
+#define MVHASH_EMPTY ((signed char)-128)
+#define MVHASH_DELETED ((signed char)-2)
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+mvhash_t* mvhash_alloc(
+        size_t capacity,
+        size_t key_size,
+        size_t value_size,
+        hashfunc_t hash,
+        memcmpfunc_t cmp
+        );
+mvhash_t* mvhash_reserve(mvhash_t* map, size_t capacity);
+mvhash_t* mvhash_put(mvhash_t* map, const void* key, const void* value);
+void* mvhash_get(mvhash_t* map, const void* key);
+int mvhash_remove(mvhash_t* map, const void* key);
+size_t mvhash_next(mvhash_t* map, size_t slot);
+static inline size_t mvhash_len(mvhash_t* map);
+static inline size_t mvhash_cap(mvhash_t* map);
+static inline void* mvhash_key(mvhash_t* map, size_t slot);
+static inline void* mvhash_value(mvhash_t* map, size_t slot);
+
+// Returns amount of elements stored in the given map.
+// UB: map == NULL or address of not a valid hash map
+static inline size_t mvhash_len(mvhash_t* map) {
+    return map->length;
+}
+
+// Returns amount of slots of the given map. It is always larger than the
+// amount of elements the map can hold before growing.
+// UB: map == NULL or address of not a valid hash map
+static inline size_t mvhash_cap(mvhash_t* map) {
+    return map->capacity;
+}
+
+// Returns a pointer to the key stored in the given slot. Slots of the stored
+// elements can be iterated with mvhash_next().
+// UB:
+//  @ map == NULL or address of not a valid hash map
+//  @ slot >= mvhash_cap(map)
+static inline void* mvhash_key(mvhash_t* map, size_t slot) {
+    return (char*)map + map->keys_offset + slot * map->key_size;
+}
+
+// Returns a pointer to the value stored in the given slot.
+// UB:
+//  @ map == NULL or address of not a valid hash map
+//  @ slot >= mvhash_cap(map)
+static inline void* mvhash_value(mvhash_t* map, size_t slot) {
+    return (char*)map + map->values_offset + slot * map->value_size;
+}
+
+#ifdef MVHASH_IMPLEMENTATION
+#undef MVHASH_IMPLEMENTATION
+
+#include <stdint.h> // uint64_t
+#include <string.h> // memcpy, memmove, memcmp, memset
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2 intrinsics
+#define MVHASH_SSE2
+#endif // __SSE2__ || _M_X64
+
+static inline signed char* mvhash_ctrl(mvhash_t* map) {
+    return (signed char*)(map + 1);
+}
+
+static inline size_t mvhash_alignUp(size_t bytes) {
+    return (bytes + sizeof(size_t) - 1) & ~(sizeof(size_t) - 1);
+}
+
+static inline unsigned mvhash_ctz(unsigned mask) {
+#if defined(__GNUC__)
+    return (unsigned)__builtin_ctz(mask);
+#else // !__GNUC__
+    unsigned n = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        n++;
+    }
+    return n;
+#endif // __GNUC__
+}
+
+// Bit i of the result is set if i-th control byte of the group equals h
+static inline unsigned mvhash_match(const signed char* group, signed char h) {
+#ifdef MVHASH_SSE2
+    __m128i ctrl = _mm_loadu_si128((const __m128i*)group);
+    return (unsigned)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h)));
+#else // !MVHASH_SSE2
+    unsigned mask = 0;
+    for (unsigned i = 0; i < MVHASH_GROUP; i++)
+        mask |= (unsigned)(group[i] == h) << i;
+    return mask;
+#endif // MVHASH_SSE2
+}
+
+// Bit i of the result is set if i-th slot of the group is empty or deleted,
+// i.e. if the sign bit of its control byte is set
+static inline unsigned mvhash_matchFree(const signed char* group) {
+#ifdef MVHASH_SSE2
+    return (unsigned)_mm_movemask_epi8(
+            _mm_loadu_si128((const __m128i*)group)
+            );
+#else // !MVHASH_SSE2
+    unsigned mask = 0;
+    for (unsigned i = 0; i < MVHASH_GROUP; i++)
+        mask |= (unsigned)(group[i] < 0) << i;
+    return mask;
+#endif // MVHASH_SSE2
+}
+
+// Default hash function: mixes 8 bytes at a time and finalizes the result
+// with MurmurHash3's fmix64
+static size_t mvhash_defaultHash(const void* key, size_t key_size) {
+    const unsigned char* bytes = key;
+    uint64_t h = 0xcbf29ce484222325ull ^ key_size;
+    size_t i = 0;
+    for (; i + 8 <= key_size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        h = (h ^ word) * 0x9e3779b97f4a7c15ull;
+        h ^= h >> 32;
+    }
+    for (; i < key_size; i++)
+        h = (h ^ bytes[i]) * 0x100000001b3ull;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+static inline size_t mvhash_hashOf(mvhash_t* map, const void* key) {
+    return map->hash(key, map->key_size);
+}
+
+// Sets the control byte of the given slot and its mirror, if it has one
+static inline void mvhash_setCtrl(mvhash_t* map, size_t slot, signed char h) {
+    signed char* ctrl = mvhash_ctrl(map);
+    ctrl[slot] = h;
+    if (slot < MVHASH_GROUP) ctrl[map->capacity + slot] = h;
+}
+
+// Maximum amount of elements in a map with the given amount of slots, i.e.
+// the load factor is 7/8
+static inline size_t mvhash_maxLength(size_t capacity) {
+    return capacity - capacity / 8;
+}
+
+// Smallest amount of slots to hold the given amount of elements
+static size_t mvhash_slotsFor(size_t length) {
+    size_t capacity = MVHASH_GROUP;
+    while (mvhash_maxLength(capacity) < length) capacity *= 2;
+    return capacity;
+}
+
+// Computes offsets of the key and value slots for the given amount of slots.
+// Returns the physical size of the map's data in bytes
+static size_t mvhash_layout(
+        size_t capacity,
+        size_t key_size,
+        size_t value_size,
+        size_t* keys_offset,
+        size_t* values_offset
+        )
+{
+    *keys_offset = mvhash_alignUp(
+            sizeof(MvhashHeader) + capacity + MVHASH_GROUP
+            );
+    *values_offset = mvhash_alignUp(*keys_offset + capacity * key_size);
+    return *values_offset + capacity * value_size;
+}
+
+// Probes the groups of slots starting from the home slot of the given hash,
+// moving by 1, 2, 3... groups further each time. With a power of two amount
+// of slots, this sequence visits every slot. Returns the slot of the element
+// with the given key or the map's capacity if there is no such element
+static size_t mvhash_find(mvhash_t* map, const void* key, size_t hash) {
+    signed char* ctrl = mvhash_ctrl(map);
+    size_t mask = map->capacity - 1;
+    signed char h2 = (signed char)(hash & 0x7f);
+    size_t pos = (hash >> 7) & mask;
+    for (size_t step = MVHASH_GROUP;; step += MVHASH_GROUP) {
+        for (unsigned m = mvhash_match(ctrl + pos, h2); m; m &= m - 1) {
+            size_t slot = (pos + mvhash_ctz(m)) & mask;
+            if (map->cmp(mvhash_key(map, slot), key, map->key_size) == 0)
+                return slot;
+        }
+        if (mvhash_match(ctrl + pos, MVHASH_EMPTY)) return map->capacity;
+        pos = (pos + step) & mask;
+    }
+}
+
+// Returns the first empty or deleted slot on the probe sequence of the given
+// hash
+static size_t mvhash_findFree(mvhash_t* map, size_t hash) {
+    signed char* ctrl = mvhash_ctrl(map);
+    size_t mask = map->capacity - 1;
+    size_t pos = (hash >> 7) & mask;
+    for (size_t step = MVHASH_GROUP;; step += MVHASH_GROUP) {
+        unsigned m = mvhash_matchFree(ctrl + pos);
+        if (m) return (pos + mvhash_ctz(m)) & mask;
+        pos = (pos + step) & mask;
+    }
+}
+
+static void mvhash_swap(char* a, char* b, size_t bytes) {
+    char tmp[64];
+    while (bytes) {
+        size_t chunk = bytes < sizeof(tmp) ? bytes : sizeof(tmp);
+        MVEC_MEMCPY_FUNCTION(tmp, a, chunk);
+        MVEC_MEMCPY_FUNCTION(a, b, chunk);
+        MVEC_MEMCPY_FUNCTION(b, tmp, chunk);
+        a += chunk;
+        b += chunk;
+        bytes -= chunk;
+    }
+}
+
+// Puts every element whose slot is marked with MVHASH_DELETED back on its
+// probe sequence without any extra memory, the way SwissTable does it: an
+// element either stays in its group, moves to an empty slot or swaps places
+// with another element waiting to be rehashed. Slots marked as deleted before
+// the call must be marked as empty
+static void mvhash_rehashInPlace(mvhash_t* map) {
+    signed char* ctrl = mvhash_ctrl(map);
+    size_t mask = map->capacity - 1;
+    for (size_t slot = 0; slot < map->capacity; slot++) {
+        if (ctrl[slot] != MVHASH_DELETED) continue;
+        size_t hash = mvhash_hashOf(map, mvhash_key(map, slot));
+        signed char h2 = (signed char)(hash & 0x7f);
+        size_t home = (hash >> 7) & mask;
+        size_t target = mvhash_findFree(map, hash);
+        if (((target - home) & mask) / MVHASH_GROUP
+                == ((slot - home) & mask) / MVHASH_GROUP) {
+            mvhash_setCtrl(map, slot, h2);
+            continue;
+        }
+        if (ctrl[target] == MVHASH_EMPTY) {
+            mvhash_setCtrl(map, target, h2);
+            MVEC_MEMCPY_FUNCTION(mvhash_key(map, target), mvhash_key(map, slot),
+                    map->key_size);
+            MVEC_MEMCPY_FUNCTION(mvhash_value(map, target),
+                    mvhash_value(map, slot),
+                    map->value_size);
+            mvhash_setCtrl(map, slot, MVHASH_EMPTY);
+            continue;
+        }
+        // The target waits to be rehashed too: take its place and rehash its
+        // element from the current slot
+        mvhash_setCtrl(map, target, h2);
+        mvhash_swap(mvhash_key(map, target), mvhash_key(map, slot),
+                map->key_size);
+        mvhash_swap(mvhash_value(map, target), mvhash_value(map, slot),
+                map->value_size);
+        slot--;
+    }
+    map->growth_left = mvhash_maxLength(map->capacity) - map->length;
+}
+
+// Rehashes the given map into new_capacity slots. Growing resizes the map's
+// memory chunk with mvresize() and rehashes the elements in place, so no
+// second copy of the table is ever allocated. Returns NULL on failure
+static mvhash_t* mvhash_rehash(mvhash_t* map, size_t new_capacity) {
+    size_t old_capacity = map->capacity;
+    if (new_capacity > old_capacity) {
+        size_t keys_offset, values_offset;
+        size_t bytes = mvhash_layout(
+                new_capacity, map->key_size, map->value_size,
+                &keys_offset, &values_offset
+                );
+        mvhash_t* grown = mvresize(map, bytes);
+        if (!grown) return NULL;
+        map = grown;
+        *mvlen(map) = bytes;
+        // Both slot arrays move towards the end, values first
+        MVEC_MEMMOVE_FUNCTION((char*)map + values_offset,
+                (char*)map + map->values_offset,
+                old_capacity * map->value_size);
+        MVEC_MEMMOVE_FUNCTION((char*)map + keys_offset,
+                (char*)map + map->keys_offset,
+                old_capacity * map->key_size);
+        map->keys_offset = keys_offset;
+        map->values_offset = values_offset;
+        map->capacity = new_capacity;
+    }
+    signed char* ctrl = mvhash_ctrl(map);
+    for (size_t slot = 0; slot < old_capacity; slot++)
+        ctrl[slot] = ctrl[slot] >= 0 ? MVHASH_DELETED : MVHASH_EMPTY;
+    memset(ctrl + old_capacity, MVHASH_EMPTY, map->capacity - old_capacity);
+    MVEC_MEMCPY_FUNCTION(ctrl + map->capacity, ctrl, MVHASH_GROUP);
+    mvhash_rehashInPlace(map);
+    return map;
+}
+
+// Allocates a new hash map able to hold the given capacity of elements
+// without growing. Keys are key_size bytes each and values are value_size
+// bytes each; both get stored in slots aligned to sizeof(size_t) relative to
+// the map. If hash or cmp is NULL, keys are hashed and compared bytewise (so
+// keys containing padding bytes or pointers need custom ones). On success,
+// returns a pointer to the newly allocated map. On failure, returns NULL.
+// UB:
+//  @ key_size == 0
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvhash_t* mvhash_alloc(
+        size_t capacity,
+        size_t key_size,
+        size_t value_size,
+        hashfunc_t hash,
+        memcmpfunc_t cmp
+        )
+{
+    size_t slots = mvhash_slotsFor(capacity);
+    size_t keys_offset, values_offset;
+    size_t bytes = mvhash_layout(
+            slots, key_size, value_size, &keys_offset, &values_offset
+            );
+    mvhash_t* map = mvalloc(bytes, 1);
+    if (!map) return NULL;
+    *mvlen(map) = bytes;
+    map->length = 0;
+    map->capacity = slots;
+    map->growth_left = mvhash_maxLength(slots);
+    map->key_size = key_size;
+    map->value_size = value_size;
+    map->keys_offset = keys_offset;
+    map->values_offset = values_offset;
+    map->hash = hash ? hash : mvhash_defaultHash;
+    map->cmp = cmp ? cmp : memcmp;
+    memset(mvhash_ctrl(map), MVHASH_EMPTY, slots + MVHASH_GROUP);
+    return map;
+}
+
+// Makes the given map able to hold the given capacity of elements without
+// growing. Never shrinks the map. On success, returns a pointer to the map;
+// its pointer's previous value and all the pointers to its keys and values get
+// invalidated. On failure, returns NULL; the state and the data of the given
+// map remain untouched.
+// UB: map == NULL or address of not a valid hash map
+mvhash_t* mvhash_reserve(mvhash_t* map, size_t capacity) {
+    size_t slots = mvhash_slotsFor(capacity);
+    if (slots <= map->capacity) return map;
+    return mvhash_rehash(map, slots);
+}
+
+// Copies the given key and value into the given map. If the key is already
+// there, only its value gets overwritten. If the map is full, either cleans
+// up the removed elements' slots or doubles the amount of slots first. On
+// success, returns a pointer to the map; its pointer's previous value and all
+// the pointers to its keys and values may get invalidated. On failure,
+// returns NULL; the state and the data of the given map remain untouched.
+// UB:
+//  @ map == NULL or address of not a valid hash map
+//  @ key or value points inside the map
+mvhash_t* mvhash_put(mvhash_t* map, const void* key, const void* value) {
+    size_t hash = mvhash_hashOf(map, key);
+    size_t slot = mvhash_find(map, key, hash);
+    if (slot != map->capacity) {
+        MVEC_MEMCPY_FUNCTION(mvhash_value(map, slot), value, map->value_size);
+        return map;
+    }
+    slot = mvhash_findFree(map, hash);
+    if (mvhash_ctrl(map)[slot] == MVHASH_EMPTY && map->growth_left == 0) {
+        // Mostly removed elements' slots: cleaning them up is enough
+        mvhash_t* rehashed = mvhash_rehash(
+                map,
+                map->length <= mvhash_maxLength(map->capacity) / 2
+                    ? map->capacity : map->capacity * 2
+                );
+        if (!rehashed) return NULL;
+        map = rehashed;
+        slot = mvhash_findFree(map, hash);
+    }
+    if (mvhash_ctrl(map)[slot] == MVHASH_EMPTY) map->growth_left--;
+    mvhash_setCtrl(map, slot, (signed char)(hash & 0x7f));
+    MVEC_MEMCPY_FUNCTION(mvhash_key(map, slot), key, map->key_size);
+    MVEC_MEMCPY_FUNCTION(mvhash_value(map, slot), value, map->value_size);
+    map->length++;
+    return map;
+}
+
+// Returns a pointer to the value stored with the given key in the given map,
+// or NULL if there is no such key. The pointer gets invalidated by every
+// function that may rehash the map.
+// UB: map == NULL or address of not a valid hash map
+void* mvhash_get(mvhash_t* map, const void* key) {
+    size_t slot = mvhash_find(map, key, mvhash_hashOf(map, key));
+    return slot == map->capacity ? NULL : mvhash_value(map, slot);
+}
+
+// Removes the element with the given key from the given map. Returns 1 if it
+// was found, 0 otherwise. Its slot gets reused by the next insertions or
+// cleaned up by the next rehash.
+// UB: map == NULL or address of not a valid hash map
+int mvhash_remove(mvhash_t* map, const void* key) {
+    size_t slot = mvhash_find(map, key, mvhash_hashOf(map, key));
+    if (slot == map->capacity) return 0;
+    mvhash_setCtrl(map, slot, MVHASH_DELETED);
+    map->length--;
+    return 1;
+}
+
+// Returns the first slot starting from the given one that stores an element,
+// or the map's capacity if there is no such slot. Iterate over the map like
+// this:
+//  for (size_t s = mvhash_next(map, 0); s < mvhash_cap(map);
+//          s = mvhash_next(map, s + 1))
+// UB:
+//  @ map == NULL or address of not a valid hash map
+//  @ slot > mvhash_cap(map)
+size_t mvhash_next(mvhash_t* map, size_t slot) {
+    signed char* ctrl = mvhash_ctrl(map);
+    while (slot < map->capacity && ctrl[slot] < 0) slot++;
+    return slot;
+}
+
+#endif // MVHASH_IMPLEMENTATION
+#endif // !MVHASH_H
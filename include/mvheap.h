@@ -0,0 +1,408 @@
+// mvheap.h - D-ary heaps in monolithic vectors
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVHEAP_H
+#define MVHEAP_H
+
+#include <stdint.h> // uint64_t
+
+#include "mvec.h"
+
+// Amount of children of every node. With 4 or 8 children of 8 bytes or less
+// each, all the children of a node take one or two cache lines, and the heap
+// is two or three times shallower than a binary one. Must be the same in all
+// the translation units working with the same heaps
+#ifndef MVHEAP_ARITY
+#define MVHEAP_ARITY 4
+#endif // !MVHEAP_ARITY
+
+// A heap is an ordinary mvec whose element with index i is not greater by
+// a comparator than its children with indices from i * MVHEAP_ARITY + 1 to
+// i * MVHEAP_ARITY + MVHEAP_ARITY, so the first element is the smallest one
+// (reverse the comparator to get a max-heap). Elements are moved with
+// memcpy() into a hole instead of being swapped. Functions with the U64
+// suffix are fast paths for heaps of uint64_t (for instance, priorities in
+// the upper bits and ids in the lower ones) and do not take a comparator.
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+mvec_t* mvheap_push(mvec_t* mvec, const void* element, cmpfunc_t cmp);
+mvec_t* mvheap_pushMany(
+        mvec_t* mvec,
+        const void* elements,
+        size_t quantity,
+        cmpfunc_t cmp
+        );
+int mvheap_pop(mvec_t* mvec, void* top, cmpfunc_t cmp);
+void mvheap_replaceTop(
+        mvec_t* mvec,
+        const void* element,
+        void* top,
+        cmpfunc_t cmp
+        );
+int mvheap_heapify(mvec_t* mvec, cmpfunc_t cmp);
+static inline void* mvheap_top(mvec_t* mvec);
+
+mvec_t* mvheap_pushU64(mvdef uint64_t* mvec, uint64_t element);
+mvec_t* mvheap_pushManyU64(
+        mvdef uint64_t* mvec,
+        const uint64_t* elements,
+        size_t quantity
+        );
+int mvheap_popU64(mvdef uint64_t* mvec, uint64_t* top);
+uint64_t mvheap_replaceTopU64(mvdef uint64_t* mvec, uint64_t element);
+void mvheap_heapifyU64(mvdef uint64_t* mvec);
+
+// Returns address of the smallest element of the given heap. If it's empty,
+// returns NULL.
+// UB: mvec == NULL or address of not a valid mvector
+static inline void* mvheap_top(mvec_t* mvec) {
+    return *mvlen(mvec) ? mvec : NULL;
+}
+
+#ifdef MVHEAP_IMPLEMENTATION
+#undef MVHEAP_IMPLEMENTATION
+
+#include <string.h> // memcpy
+
+// Elements up to this size are kept on the stack by mvheap_heapify()
+#define MVHEAP_STACK_ELEMENT 64
+
+// Moves the hole at the given index of the heap up to where the given value
+// belongs and puts the value there
+static void mvheap_siftUp(
+        char* heap,
+        size_t element_size,
+        size_t hole,
+        const void* value,
+        cmpfunc_t cmp
+        )
+{
+    while (hole) {
+        size_t parent = (hole - 1) / MVHEAP_ARITY;
+        const char* above = heap + parent * element_size;
+        if (cmp(value, above) >= 0) break;
+        MVEC_MEMCPY_FUNCTION(heap + hole * element_size, above, element_size);
+        hole = parent;
+    }
+    MVEC_MEMCPY_FUNCTION(heap + hole * element_size, value, element_size);
+}
+
+// Moves the hole at the given index of the heap of the given length down to
+// where the given value belongs and puts the value there. The value must not
+// be inside the heap
+static void mvheap_siftDown(
+        char* heap,
+        size_t element_size,
+        size_t length,
+        size_t hole,
+        const void* value,
+        cmpfunc_t cmp
+        )
+{
+    for (;;) {
+        size_t first = hole * MVHEAP_ARITY + 1;
+        if (first >= length) break;
+        size_t end = length - first < MVHEAP_ARITY
+            ? length : first + MVHEAP_ARITY;
+        const char* least = heap + first * element_size;
+        size_t least_index = first;
+        for (size_t i = first + 1; i < end; i++) {
+            const char* child = heap + i * element_size;
+            if (cmp(child, least) < 0) {
+                least = child;
+                least_index = i;
+            }
+        }
+        if (cmp(least, value) >= 0) break;
+        MVEC_MEMCPY_FUNCTION(heap + hole * element_size, least, element_size);
+        hole = least_index;
+    }
+    MVEC_MEMCPY_FUNCTION(heap + hole * element_size, value, element_size);
+}
+
+// Copies the given element into the given heap. If the heap is full, its
+// capacity gets doubled first. On success, returns a pointer to the heap; its
+// pointer's previous value may get invalidated. On failure, returns NULL; the
+// state and the data of the given heap remain untouched.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not a heap by cmp
+//  @ element points inside the heap
+mvec_t* mvheap_push(mvec_t* mvec, const void* element, cmpfunc_t cmp) {
+    if (*mvlen(mvec) == mvcap(mvec)) {
+        mvec_t* new_mvec = mvresize(mvec, mvcap(mvec) ? mvcap(mvec) * 2 : 1);
+        if (!new_mvec) return NULL;
+        mvec = new_mvec;
+    }
+    size_t length = (*mvlen(mvec))++;
+    mvheap_siftUp(mvec, mvelsz(mvec), length, element, cmp);
+    return mvec;
+}
+
+// Copies quantity elements from the given address into the given heap. If
+// there are more of them than elements in the heap, appends them and rebuilds
+// the heap in O(length + quantity), otherwise pushes them one by one. If the
+// heap is too small, it gets resized to at least twice its capacity first. On
+// success, returns a pointer to the heap; its pointer's previous value may get
+// invalidated. On failure, returns NULL; the state and the data of the given
+// heap remain untouched.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not a heap by cmp
+//  @ elements point inside the heap
+mvec_t* mvheap_pushMany(
+        mvec_t* mvec,
+        const void* elements,
+        size_t quantity,
+        cmpfunc_t cmp
+        )
+{
+    size_t length = *mvlen(mvec);
+    size_t element_size = mvelsz(mvec);
+    // Leaves a spare element for mvheap_heapify() to keep large ones in, so
+    // that it never fails here
+    size_t needed = length + quantity
+        + (element_size > MVHEAP_STACK_ELEMENT);
+    if (needed > mvcap(mvec)) {
+        size_t capacity = mvcap(mvec) * 2;
+        if (capacity < needed) capacity = needed;
+        mvec_t* new_mvec = mvresize(mvec, capacity);
+        if (!new_mvec) return NULL;
+        mvec = new_mvec;
+    }
+    if (quantity > length) {
+        MVEC_MEMCPY_FUNCTION((char*)mvec + length * element_size, elements,
+                quantity * element_size);
+        *mvlen(mvec) = length + quantity;
+        mvheap_heapify(mvec, cmp);
+        return mvec;
+    }
+    for (size_t i = 0; i < quantity; i++) {
+        mvheap_siftUp(mvec, element_size, (*mvlen(mvec))++,
+                (const char*)elements + i * element_size, cmp);
+    }
+    return mvec;
+}
+
+// Removes the smallest element from the given heap and copies it to top if
+// it isn't NULL. Returns 1 if the heap wasn't empty, 0 otherwise.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not a heap by cmp
+//  @ top is not NULL and is not a valid pointer to mvelsz(mvec) bytes
+//  @ top points inside the heap
+int mvheap_pop(mvec_t* mvec, void* top, cmpfunc_t cmp) {
+    size_t length = *mvlen(mvec);
+    if (!length) return 0;
+    size_t element_size = mvelsz(mvec);
+    if (top) MVEC_MEMCPY_FUNCTION(top, mvec, element_size);
+    *mvlen(mvec) = --length;
+    // The last element stays in place beyond the length while it's sifted
+    if (length) {
+        mvheap_siftDown(mvec, element_size, length, 0,
+                (char*)mvec + length * element_size, cmp);
+    }
+    return 1;
+}
+
+// Replaces the smallest element of the given heap with the given one, which
+// is cheaper than mvheap_pop() followed by mvheap_push(). Copies the smallest
+// element to top first if it isn't NULL.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not a heap by cmp
+//  @ the heap is empty
+//  @ top is not NULL and is not a valid pointer to mvelsz(mvec) bytes
+//  @ element or top points inside the heap
+void mvheap_replaceTop(
+        mvec_t* mvec,
+        const void* element,
+        void* top,
+        cmpfunc_t cmp
+        )
+{
+    size_t element_size = mvelsz(mvec);
+    if (top) MVEC_MEMCPY_FUNCTION(top, mvec, element_size);
+    mvheap_siftDown(mvec, element_size, *mvlen(mvec), 0, element, cmp);
+}
+
+// Rearranges the elements of the given mvec into a heap by cmp in O(length)
+// with Floyd's method. Elements larger than MVHEAP_STACK_ELEMENT bytes are
+// kept in the spare capacity while they are sifted, or in a temporary mvec if
+// the vector is full. Returns 1 on success. On failure (only if it can't
+// allocate the temporary mvec), returns 0; the order of the elements is
+// unspecified then.
+// UB: mvec == NULL or address of not a valid mvector
+int mvheap_heapify(mvec_t* mvec, cmpfunc_t cmp) {
+    size_t length = *mvlen(mvec);
+    size_t element_size = mvelsz(mvec);
+    if (length < 2) return 1;
+    uint64_t stack[MVHEAP_STACK_ELEMENT / sizeof(uint64_t)];
+    mvdef char* temporary = NULL;
+    char* value = (char*)stack;
+    if (element_size > MVHEAP_STACK_ELEMENT) {
+        if (length < mvcap(mvec)) {
+            value = (char*)mvec + length * element_size;
+        } else {
+            temporary = mvalloc(1, element_size);
+            if (!temporary) return 0;
+            value = temporary;
+        }
+    }
+    for (size_t i = (length - 2) / MVHEAP_ARITY + 1; i-- > 0;) {
+        MVEC_MEMCPY_FUNCTION(value, (char*)mvec + i * element_size,
+                element_size);
+        mvheap_siftDown(mvec, element_size, length, i, value, cmp);
+    }
+    if (temporary) mvfree(temporary);
+    return 1;
+}
+
+// The same as mvheap_siftUp() and mvheap_siftDown() for uint64_t heaps
+static void mvheap_siftUpU64(uint64_t* heap, size_t hole, uint64_t value) {
+    while (hole) {
+        size_t parent = (hole - 1) / MVHEAP_ARITY;
+        if (value >= heap[parent]) break;
+        heap[hole] = heap[parent];
+        hole = parent;
+    }
+    heap[hole] = value;
+}
+
+static void mvheap_siftDownU64(
+        uint64_t* heap,
+        size_t length,
+        size_t hole,
+        uint64_t value
+        )
+{
+    // Nodes whose children are all there don't need the bounds check
+    size_t full = length >= MVHEAP_ARITY + 1
+        ? (length - MVHEAP_ARITY - 1) / MVHEAP_ARITY + 1 : 0;
+    while (hole < full) {
+        const uint64_t* children = heap + hole * MVHEAP_ARITY + 1;
+        size_t least = 0;
+        for (size_t i = 1; i < MVHEAP_ARITY; i++)
+            least = children[i] < children[least] ? i : least;
+        if (children[least] >= value) break;
+        heap[hole] = children[least];
+        hole = hole * MVHEAP_ARITY + 1 + least;
+    }
+    size_t first = hole * MVHEAP_ARITY + 1;
+    if (hole >= full && first < length) {
+        size_t least = first;
+        for (size_t i = first + 1; i < length; i++)
+            least = heap[i] < heap[least] ? i : least;
+        if (heap[least] < value) {
+            heap[hole] = heap[least];
+            hole = least;
+        }
+    }
+    heap[hole] = value;
+}
+
+// Fast path of mvheap_push() for uint64_t heaps in ascending order.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not a heap in ascending order
+mvec_t* mvheap_pushU64(mvdef uint64_t* mvec, uint64_t element) {
+    if (*mvlen(mvec) == mvcap(mvec)) {
+        mvdef uint64_t* new_mvec =
+            mvresize(mvec, mvcap(mvec) ? mvcap(mvec) * 2 : 1);
+        if (!new_mvec) return NULL;
+        mvec = new_mvec;
+    }
+    mvheap_siftUpU64(mvec, (*mvlen(mvec))++, element);
+    return mvec;
+}
+
+// Fast path of mvheap_pushMany() for uint64_t heaps in ascending order.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not a heap in ascending order
+//  @ elements point inside the heap
+mvec_t* mvheap_pushManyU64(
+        mvdef uint64_t* mvec,
+        const uint64_t* elements,
+        size_t quantity
+        )
+{
+    size_t length = *mvlen(mvec);
+    if (length + quantity > mvcap(mvec)) {
+        size_t capacity = mvcap(mvec) * 2;
+        if (capacity < length + quantity) capacity = length + quantity;
+        mvdef uint64_t* new_mvec = mvresize(mvec, capacity);
+        if (!new_mvec) return NULL;
+        mvec = new_mvec;
+    }
+    if (quantity > length) {
+        MVEC_MEMCPY_FUNCTION(mvec + length, elements,
+                quantity * sizeof(uint64_t));
+        *mvlen(mvec) = length + quantity;
+        mvheap_heapifyU64(mvec);
+        return mvec;
+    }
+    for (size_t i = 0; i < quantity; i++)
+        mvheap_siftUpU64(mvec, (*mvlen(mvec))++, elements[i]);
+    return mvec;
+}
+
+// Fast path of mvheap_pop() for uint64_t heaps in ascending order.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not a heap in ascending order
+int mvheap_popU64(mvdef uint64_t* mvec, uint64_t* top) {
+    size_t length = *mvlen(mvec);
+    if (!length) return 0;
+    if (top) *top = mvec[0];
+    *mvlen(mvec) = --length;
+    if (length) mvheap_siftDownU64(mvec, length, 0, mvec[length]);
+    return 1;
+}
+
+// Fast path of mvheap_replaceTop() for uint64_t heaps in ascending order.
+// Returns the replaced smallest element.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not a heap in ascending order
+//  @ the heap is empty
+uint64_t mvheap_replaceTopU64(mvdef uint64_t* mvec, uint64_t element) {
+    uint64_t top = mvec[0];
+    mvheap_siftDownU64(mvec, *mvlen(mvec), 0, element);
+    return top;
+}
+
+// Fast path of mvheap_heapify() for uint64_t vectors in ascending order.
+// UB: mvec == NULL or address of not a valid mvector
+void mvheap_heapifyU64(mvdef uint64_t* mvec) {
+    size_t length = *mvlen(mvec);
+    if (length < 2) return;
+    for (size_t i = (length - 2) / MVHEAP_ARITY + 1; i-- > 0;)
+        mvheap_siftDownU64(mvec, length, i, mvec[i]);
+}
+
+#endif // MVHEAP_IMPLEMENTATION
+#endif // !MVHEAP_H
@@ -0,0 +1,479 @@
+// mvpack.h - Compressed read-only representation of integer monolithic vectors
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVPACK_H
+#define MVPACK_H
+
+#include <stdint.h> // uint64_t
+#include "mvec.h"
+
+// Amount of values in a single block. Every block is packed independently, so
+// it is the granularity of random access and streaming decoding
+#define MVPACK_BLOCK 128
+
+// Bytes the packed data is padded with, so vectorized unpacking may read a bit
+// past the last block
+#define MVPACK_PADDING 32
+
+// Directory entry of a single block. Values of the block are stored as the
+// differences between the neighboring ones. The differences are stored minus
+// their minimum (reference) with the least amount of bits enough for all of
+// them. The first value is stored as is
+typedef struct mvpack_block_t {
+    uint64_t first;
+    uint64_t reference;
+    uint64_t offset_bits; // offset from the packed data << 8 | bit width
+} MvpackBlock;
+
+// A compressed vector lives in the data of a byte mvec, so it is allocated and
+// freed by the core functions [with the allocator it was allocated with]. The
+// header is followed by the directory of blocks and the packed data
+typedef struct mvpack_header_t {
+    size_t length;
+    size_t element_size;
+    size_t blocks;
+    MvpackBlock block[];
+} MvpackHeader;
+
+// Use this typedef for compressed vectors. Release them with mvfree()
+typedef MvpackHeader mvpack_t;
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+mvpack_t* mvec_compress(mvec_t* mvec);
+mvec_t* mvec_decompress(mvpack_t* pack);
+size_t mvpack_decodeBlock(mvpack_t* pack, size_t block, void* out);
+mvec_t* mvpack_decode(
+        mvpack_t* pack,
+        size_t block,
+        size_t count,
+        mvec_t* mvec
+        );
+uint64_t mvpack_get(mvpack_t* pack, size_t index);
+static inline size_t mvpack_len(mvpack_t* pack);
+static inline size_t mvpack_elsz(mvpack_t* pack);
+static inline size_t mvpack_blocks(mvpack_t* pack);
+
+// Returns amount of values stored in the given compressed vector.
+// UB: pack == NULL or address of not a valid compressed vector
+static inline size_t mvpack_len(mvpack_t* pack) {
+    return pack->length;
+}
+
+// Returns size of a single value of the given compressed vector in bytes.
+// UB: pack == NULL or address of not a valid compressed vector
+static inline size_t mvpack_elsz(mvpack_t* pack) {
+    return pack->element_size;
+}
+
+// Returns amount of blocks of the given compressed vector. All of them but
+// the last one contain MVPACK_BLOCK values.
+// UB: pack == NULL or address of not a valid compressed vector
+static inline size_t mvpack_blocks(mvpack_t* pack) {
+    return pack->blocks;
+}
+
+#ifdef MVPACK_IMPLEMENTATION
+#undef MVPACK_IMPLEMENTATION
+
+#include <string.h> // memcpy, memset
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif // __AVX2__
+
+// The widest bit width unpacked with AVX2: a value shifted by up to 7 bits
+// must fit in a 32-bit lane
+#define MVPACK_AVX2_BITS 25
+
+static inline unsigned char* mvpack_data(MvpackHeader* pack) {
+    return (unsigned char*)&pack->block[pack->blocks];
+}
+
+static inline uint64_t mvpack_mask(size_t element_size) {
+    return element_size == 8
+        ? ~(uint64_t)0 : ((uint64_t)1 << (element_size * 8)) - 1;
+}
+
+static inline uint64_t mvpack_load(const void* from, size_t element_size) {
+    uint16_t v16;
+    uint32_t v32;
+    uint64_t v64;
+    switch (element_size) {
+    case 2: memcpy(&v16, from, 2); return v16;
+    case 4: memcpy(&v32, from, 4); return v32;
+    default: memcpy(&v64, from, 8); return v64;
+    }
+}
+
+// Sign-extends the lowest element_size bytes of the given value
+static inline int64_t mvpack_signed(uint64_t value, size_t element_size) {
+    unsigned shift = 64 - (unsigned)element_size * 8;
+    return (int64_t)(value << shift) >> shift;
+}
+
+static inline unsigned mvpack_bitWidth(uint64_t value) {
+    unsigned bits = 0;
+    while (value) {
+        bits++;
+        value >>= 1;
+    }
+    return bits;
+}
+
+// Finds the reference and the bit width of the given block of count values
+static void mvpack_frame(
+        const unsigned char* values,
+        size_t count,
+        size_t element_size,
+        MvpackBlock* block
+        )
+{
+    uint64_t mask = mvpack_mask(element_size);
+    uint64_t prev = mvpack_load(values, element_size);
+    int64_t min = 0, max = 0;
+    for (size_t i = 1; i < count; i++) {
+        uint64_t value = mvpack_load(values + i * element_size, element_size);
+        int64_t delta = mvpack_signed((value - prev) & mask, element_size);
+        if (i == 1 || delta < min) min = delta;
+        if (i == 1 || delta > max) max = delta;
+        prev = value;
+    }
+    block->first = mvpack_load(values, element_size);
+    block->reference = (uint64_t)min & mask;
+    block->offset_bits = mvpack_bitWidth((uint64_t)max - (uint64_t)min);
+}
+
+// Packs MVPACK_BLOCK values of the given block with its bit width. The first
+// value and the ones past count are packed as zeros
+static void mvpack_pack(
+        const unsigned char* values,
+        size_t count,
+        size_t element_size,
+        const MvpackBlock* block,
+        unsigned char* out
+        )
+{
+    unsigned bits = block->offset_bits & 0xff;
+    uint64_t mask = mvpack_mask(element_size);
+    uint64_t words[MVPACK_BLOCK];
+    memset(words, 0, sizeof(words));
+    uint64_t prev = block->first;
+    for (size_t i = 1; i < count; i++) {
+        uint64_t value = mvpack_load(values + i * element_size, element_size);
+        uint64_t packed = (value - prev - block->reference) & mask;
+        size_t pos = i * bits;
+        words[pos / 64] |= packed << (pos % 64);
+        if (pos % 64 + bits > 64)
+            words[pos / 64 + 1] |= packed >> (64 - pos % 64);
+        prev = value;
+    }
+    MVEC_MEMCPY_FUNCTION(out, words, (size_t)bits * MVPACK_BLOCK / 8);
+}
+
+// Unpacks MVPACK_BLOCK values of up to 64 bits each
+static void mvpack_unpack64(
+        const unsigned char* in,
+        unsigned bits,
+        uint64_t* out
+        )
+{
+    uint64_t words[MVPACK_BLOCK];
+    MVEC_MEMCPY_FUNCTION(words, in, (size_t)bits * MVPACK_BLOCK / 8);
+    uint64_t mask = bits == 64 ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1;
+    for (size_t i = 0; i < MVPACK_BLOCK; i++) {
+        size_t pos = i * bits;
+        uint64_t value = words[pos / 64] >> (pos % 64);
+        if (pos % 64 + bits > 64)
+            value |= words[pos / 64 + 1] << (64 - pos % 64);
+        out[i] = value & mask;
+    }
+}
+
+// Unpacks MVPACK_BLOCK values of up to 32 bits each. With AVX2, every eight
+// values take exactly bits bytes, so the same byte shuffle and shifts extract
+// all groups of them
+static void mvpack_unpack32(
+        const unsigned char* in,
+        unsigned bits,
+        uint32_t* out
+        )
+{
+#ifdef __AVX2__
+    if (bits <= MVPACK_AVX2_BITS) {
+        unsigned char shuffle[32];
+        uint32_t shifts[8];
+        unsigned upper = (4 * bits) / 8;
+        for (unsigned k = 0; k < 8; k++) {
+            unsigned start = (k * bits) / 8 - (k < 4 ? 0 : upper);
+            for (unsigned j = 0; j < 4; j++)
+                shuffle[k * 4 + j] = (unsigned char)(start + j);
+            shifts[k] = (k * bits) % 8;
+        }
+        __m256i shuffle_v = _mm256_loadu_si256((const __m256i*)shuffle);
+        __m256i shifts_v = _mm256_loadu_si256((const __m256i*)shifts);
+        __m256i mask_v = _mm256_set1_epi32((int)((1u << bits) - 1));
+        for (unsigned g = 0; g < MVPACK_BLOCK / 8; g++) {
+            const unsigned char* group = in + g * bits;
+            __m256i bytes = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(
+                        _mm_loadu_si128((const __m128i*)group)
+                        ),
+                    _mm_loadu_si128((const __m128i*)(group + upper)),
+                    1
+                    );
+            __m256i values = _mm256_shuffle_epi8(bytes, shuffle_v);
+            values = _mm256_and_si256(
+                    _mm256_srlv_epi32(values, shifts_v),
+                    mask_v
+                    );
+            _mm256_storeu_si256((__m256i*)(out + g * 8), values);
+        }
+        return;
+    }
+#endif // __AVX2__
+    uint64_t words[MVPACK_BLOCK / 2];
+    MVEC_MEMCPY_FUNCTION(words, in, (size_t)bits * MVPACK_BLOCK / 8);
+    uint32_t mask = bits == 32 ? ~(uint32_t)0 : ((uint32_t)1 << bits) - 1;
+    for (size_t i = 0; i < MVPACK_BLOCK; i++) {
+        size_t pos = i * bits;
+        uint64_t value = words[pos / 64] >> (pos % 64);
+        if (pos % 64 + bits > 64)
+            value |= words[pos / 64 + 1] << (64 - pos % 64);
+        out[i] = (uint32_t)value & mask;
+    }
+}
+
+// Packs the given mvec of 2, 4 or 8-byte integers into a newly allocated
+// compressed vector. Values are split into blocks of MVPACK_BLOCK, each of
+// them stores the differences between the neighboring values with the least
+// sufficient bit width, so sorted and slowly changing data takes a few bits
+// per value. Signedness doesn't matter. The given mvec remains untouched. On
+// success, returns a pointer to the compressed vector. On failure or if the
+// element size is not supported, returns NULL.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvpack_t* mvec_compress(mvec_t* mvec) {
+    size_t element_size = mvelsz(mvec);
+    if (element_size != 2 && element_size != 4 && element_size != 8)
+        return NULL;
+    size_t length = *mvlen(mvec);
+    size_t blocks = (length + MVPACK_BLOCK - 1) / MVPACK_BLOCK;
+    const unsigned char* values = mvec;
+
+    // Find out the bit widths first to allocate exactly as much as needed
+    mvdef MvpackBlock* frames = mvalloc(blocks, sizeof(MvpackBlock));
+    if (!frames) return NULL;
+    size_t packed_bytes = 0;
+    for (size_t b = 0; b < blocks; b++) {
+        size_t count = length - b * MVPACK_BLOCK < MVPACK_BLOCK
+            ? length - b * MVPACK_BLOCK : MVPACK_BLOCK;
+        mvpack_frame(
+                values + b * MVPACK_BLOCK * element_size,
+                count,
+                element_size,
+                &frames[b]
+                );
+        unsigned bits = (unsigned)frames[b].offset_bits;
+        frames[b].offset_bits = packed_bytes << 8 | bits;
+        packed_bytes += (size_t)bits * MVPACK_BLOCK / 8;
+    }
+
+    size_t bytes = sizeof(MvpackHeader) + blocks * sizeof(MvpackBlock)
+        + packed_bytes + MVPACK_PADDING;
+    mvpack_t* pack = mvalloc(bytes, 1);
+    if (!pack) {
+        mvfree(frames);
+        return NULL;
+    }
+    *mvlen(pack) = bytes;
+    pack->length = length;
+    pack->element_size = element_size;
+    pack->blocks = blocks;
+    if (blocks) MVEC_MEMCPY_FUNCTION(pack->block, frames,
+            blocks * sizeof(MvpackBlock));
+    mvfree(frames);
+    unsigned char* data = mvpack_data(pack);
+    memset(data + packed_bytes, 0, MVPACK_PADDING);
+    for (size_t b = 0; b < blocks; b++) {
+        size_t count = length - b * MVPACK_BLOCK < MVPACK_BLOCK
+            ? length - b * MVPACK_BLOCK : MVPACK_BLOCK;
+        mvpack_pack(
+                values + b * MVPACK_BLOCK * element_size,
+                count,
+                element_size,
+                &pack->block[b],
+                data + (pack->block[b].offset_bits >> 8)
+                );
+    }
+    return pack;
+}
+
+// Decodes the given block of the given compressed vector into out. Returns
+// amount of decoded values, i.e. MVPACK_BLOCK for all the blocks but the last
+// one. Nothing past them gets written.
+// UB:
+//  @ pack == NULL or address of not a valid compressed vector
+//  @ block >= mvpack_blocks(pack)
+//  @ out has no room for the decoded values
+size_t mvpack_decodeBlock(mvpack_t* pack, size_t block, void* out) {
+    const MvpackBlock* frame = &pack->block[block];
+    size_t element_size = pack->element_size;
+    size_t count = pack->length - block * MVPACK_BLOCK < MVPACK_BLOCK
+        ? pack->length - block * MVPACK_BLOCK : MVPACK_BLOCK;
+    unsigned bits = frame->offset_bits & 0xff;
+    const unsigned char* in = mvpack_data(pack) + (frame->offset_bits >> 8);
+    unsigned char* to = out;
+
+    if (element_size == 8 && bits > 32) {
+        uint64_t deltas[MVPACK_BLOCK];
+        mvpack_unpack64(in, bits, deltas);
+        uint64_t value = frame->first;
+        memcpy(to, &value, 8);
+        for (size_t i = 1; i < count; i++) {
+            value += deltas[i] + frame->reference;
+            memcpy(to + i * 8, &value, 8);
+        }
+        return count;
+    }
+
+    uint32_t deltas[MVPACK_BLOCK];
+    if (bits) mvpack_unpack32(in, bits, deltas);
+    else memset(deltas, 0, sizeof(deltas));
+    switch (element_size) {
+    case 2: {
+        uint16_t value = (uint16_t)frame->first;
+        uint16_t reference = (uint16_t)frame->reference;
+        memcpy(to, &value, 2);
+        for (size_t i = 1; i < count; i++) {
+            value = (uint16_t)(value + deltas[i] + reference);
+            memcpy(to + i * 2, &value, 2);
+        }
+        break;
+    }
+    case 4: {
+        uint32_t value = (uint32_t)frame->first;
+        uint32_t reference = (uint32_t)frame->reference;
+        memcpy(to, &value, 4);
+        for (size_t i = 1; i < count; i++) {
+            value += deltas[i] + reference;
+            memcpy(to + i * 4, &value, 4);
+        }
+        break;
+    }
+    default: {
+        uint64_t value = frame->first;
+        memcpy(to, &value, 8);
+        for (size_t i = 1; i < count; i++) {
+            value += deltas[i] + frame->reference;
+            memcpy(to + i * 8, &value, 8);
+        }
+        break;
+    }
+    }
+    return count;
+}
+
+// Appends the values of count blocks of the given compressed vector starting
+// from the given block to the given mvec. Grows the mvec to fit them if
+// needed, so decoding a big vector piece by piece into the same mvec doesn't
+// allocate after the first piece. Set its length to 0 first to overwrite its
+// contents instead. On success, returns a pointer to the mvec; its pointer's
+// previous value may get invalidated. On failure, returns NULL; the state and
+// the data of the given mvec remain untouched.
+// UB:
+//  @ pack == NULL or address of not a valid compressed vector
+//  @ block + count > mvpack_blocks(pack)
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvelsz(mvec) != mvpack_elsz(pack)
+//  {@ mvec is shared, i.e. mvrefs(mvec) > 1. Call mvmut() first}
+mvec_t* mvpack_decode(
+        mvpack_t* pack,
+        size_t block,
+        size_t count,
+        mvec_t* mvec
+        )
+{
+    if (!count) return mvec;
+    size_t end = (block + count) * MVPACK_BLOCK < pack->length
+        ? (block + count) * MVPACK_BLOCK : pack->length;
+    size_t needed = *mvlen(mvec) + end - block * MVPACK_BLOCK;
+    if (mvcap(mvec) < needed) {
+        mvec_t* grown = mvresize(mvec, needed);
+        if (!grown) return NULL;
+        mvec = grown;
+    }
+    for (size_t b = block; b < block + count; b++)
+        *mvlen(mvec) += mvpack_decodeBlock(
+                pack,
+                b,
+                (unsigned char*)mvec + *mvlen(mvec) * pack->element_size
+                );
+    return mvec;
+}
+
+// Decodes the whole given compressed vector into a newly allocated mvec with
+// length and capacity equal to mvpack_len(pack). The compressed vector
+// remains untouched. On success, returns a pointer to the new mvec. On
+// failure, returns NULL.
+// UB:
+//  @ pack == NULL or address of not a valid compressed vector
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvec_t* mvec_decompress(mvpack_t* pack) {
+    mvec_t* mvec = mvalloc(pack->length, pack->element_size);
+    if (!mvec) return NULL;
+    mvec_t* decoded = mvpack_decode(pack, 0, pack->blocks, mvec);
+    if (!decoded) mvfree(mvec);
+    return decoded;
+}
+
+// Returns the value at the given index of the given compressed vector
+// zero-extended to 64 bits. Decodes only the values of its block preceding
+// it, so it's much slower than reading an mvec but doesn't need memory.
+// UB:
+//  @ pack == NULL or address of not a valid compressed vector
+//  @ index >= mvpack_len(pack)
+uint64_t mvpack_get(mvpack_t* pack, size_t index) {
+    const MvpackBlock* frame = &pack->block[index / MVPACK_BLOCK];
+    unsigned bits = frame->offset_bits & 0xff;
+    const unsigned char* in = mvpack_data(pack) + (frame->offset_bits >> 8);
+    uint64_t bit_mask = bits == 64
+        ? ~(uint64_t)0 : ((uint64_t)1 << bits) - 1;
+    uint64_t value = frame->first;
+    for (size_t i = 1; i <= index % MVPACK_BLOCK; i++) {
+        size_t pos = i * bits;
+        uint64_t lo, hi = 0;
+        memcpy(&lo, in + pos / 64 * 8, 8);
+        if (pos % 64 + bits > 64) memcpy(&hi, in + pos / 64 * 8 + 8, 8);
+        uint64_t delta = lo >> (pos % 64);
+        if (pos % 64) delta |= hi << (64 - pos % 64);
+        value += (delta & bit_mask) + frame->reference;
+    }
+    return value & mvpack_mask(pack->element_size);
+}
+
+#endif // MVPACK_IMPLEMENTATION
+#endif // !MVPACK_H
@@ -0,0 +1,620 @@
+// mvpar.h - Parallel algorithms over monolithic vectors
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVPAR_H
+#define MVPAR_H
+
+#include <pthread.h>
+#include <stdint.h> // uint64_t
+#include "mvec.h"
+
+// Work is split into chunks of at least MVPAR_MIN_CHUNK and at most
+// MVPAR_MAX_CHUNK bytes, as many as needed to give every thread
+// MVPAR_CHUNKS_PER_THREAD of them. Chunk sizes are multiples of
+// MVPAR_CACHE_LINE bytes, so two chunks share at most one cache line
+#ifndef MVPAR_MIN_CHUNK
+#define MVPAR_MIN_CHUNK 4096
+#endif // !MVPAR_MIN_CHUNK
+#ifndef MVPAR_MAX_CHUNK
+#define MVPAR_MAX_CHUNK (256 * 1024)
+#endif // !MVPAR_MAX_CHUNK
+#ifndef MVPAR_CHUNKS_PER_THREAD
+#define MVPAR_CHUNKS_PER_THREAD 8
+#endif // !MVPAR_CHUNKS_PER_THREAD
+#ifndef MVPAR_CACHE_LINE
+#define MVPAR_CACHE_LINE 64
+#endif // !MVPAR_CACHE_LINE
+
+// Called for a chunk of count elements starting at first, which is the
+// element with the given index of the vector
+typedef void (*rangefunc_t)(void* first, size_t count, size_t index, void* arg);
+// Called for a chunk of count elements of the source vector and the same
+// amount of elements of the destination one
+typedef void (*mapfunc_t)(void* dest, const void* src, size_t count, void* arg);
+// Associative operation: acc = acc (op) element. Both have the element size
+// of the vector it's applied to. It doesn't have to be commutative
+typedef void (*opfunc_t)(void* acc, const void* element, void* arg);
+
+// Per-thread range of chunks of the current job: the lower 32 bits are the
+// next chunk to take, the higher ones are the end. The owner takes chunks from
+// the start, the other threads steal the upper half
+typedef struct mvpar_range_t {
+    uint64_t range;
+    char padding[MVPAR_CACHE_LINE - sizeof(uint64_t)];
+} MvparRange;
+
+struct mvpar_pool_t;
+
+typedef struct mvpar_worker_t {
+    pthread_t thread;
+    struct mvpar_pool_t* pool;
+    size_t self;
+} MvparWorker;
+
+// A thread pool. The thread calling the parallel functions works as one of
+// its threads. Only one parallel function can run on a pool at a time
+typedef struct mvpar_pool_t {
+    size_t threads;
+    mvdef MvparWorker* workers; // [0] is unused: it's the calling thread
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    size_t generation;
+    size_t busy;
+    int stop;
+    void (*run)(void* job, size_t chunk);
+    void* job;
+    mvdef MvparRange* ranges;
+} MvparPool;
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+MvparPool* mvpar_create(size_t threads);
+void mvpar_destroy(MvparPool* pool);
+size_t mvpar_threads(MvparPool* pool);
+void mvpar_forEach(
+        MvparPool* pool,
+        mvec_t* mvec,
+        rangefunc_t func,
+        void* arg
+        );
+mvec_t* mvpar_map(
+        MvparPool* pool,
+        mvec_t* dest,
+        mvec_t* src,
+        mapfunc_t func,
+        void* arg
+        );
+int mvpar_reduce(
+        MvparPool* pool,
+        mvec_t* mvec,
+        void* result,
+        const void* identity,
+        opfunc_t op,
+        void* arg
+        );
+mvec_t* mvpar_scan(
+        MvparPool* pool,
+        mvec_t* dest,
+        mvec_t* src,
+        const void* identity,
+        opfunc_t op,
+        void* arg,
+        int exclusive
+        );
+
+#ifdef MVPAR_IMPLEMENTATION
+#undef MVPAR_IMPLEMENTATION
+
+#include <string.h> // memcpy
+#include <unistd.h> // sysconf
+
+// Chunking of a vector of length elements
+typedef struct mvpar_chunks_t {
+    size_t length;
+    size_t size; // elements per chunk
+    size_t count;
+} MvparChunks;
+
+// Everything a job needs to process any of its chunks
+typedef struct mvpar_job_t {
+    MvparChunks chunks;
+    char* src;
+    size_t src_size;
+    char* dest;
+    size_t dest_size;
+    rangefunc_t range;
+    mapfunc_t map;
+    opfunc_t op;
+    void* arg;
+    const void* identity;
+    char* partials; // an element per chunk
+    char* scratch;  // an element per chunk
+    int exclusive;
+} MvparJob;
+
+// Splits length elements into chunks for the given pool. The chunk size is
+// chosen by the larger of the element sizes and is a multiple of cache lines
+// for both of them whenever possible
+static MvparChunks mvpar_chunk(
+        MvparPool* pool,
+        size_t length,
+        size_t element_size,
+        size_t other_size
+        )
+{
+    size_t threads = pool ? pool->threads : 1;
+    size_t larger = element_size > other_size ? element_size : other_size;
+    size_t bytes = length * larger / (threads * MVPAR_CHUNKS_PER_THREAD);
+    if (bytes < MVPAR_MIN_CHUNK) bytes = MVPAR_MIN_CHUNK;
+    if (bytes > MVPAR_MAX_CHUNK) bytes = MVPAR_MAX_CHUNK;
+    size_t step = 1;
+    while (step < MVPAR_CACHE_LINE
+            && (step * element_size % MVPAR_CACHE_LINE
+                || step * other_size % MVPAR_CACHE_LINE))
+        step *= 2;
+    size_t size = larger ? bytes / larger : length;
+    size = size < step ? step : size / step * step;
+    MvparChunks chunks = {length, size, 0};
+    if (size) chunks.count = (length + size - 1) / size;
+    return chunks;
+}
+
+static inline size_t mvpar_chunkStart(const MvparChunks* chunks, size_t c) {
+    return c * chunks->size;
+}
+
+static inline size_t mvpar_chunkLength(const MvparChunks* chunks, size_t c) {
+    size_t start = c * chunks->size;
+    return chunks->length - start < chunks->size
+        ? chunks->length - start : chunks->size;
+}
+
+// Takes the next chunk of the given range. Returns 0 if it's empty
+static int mvpar_take(MvparRange* own, size_t* chunk) {
+    uint64_t range = __atomic_load_n(&own->range, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint64_t begin = range & 0xffffffffu, end = range >> 32;
+        if (begin >= end) return 0;
+        if (__atomic_compare_exchange_n(
+                    &own->range, &range, end << 32 | (begin + 1),
+                    0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+                    )) {
+            *chunk = (size_t)begin;
+            return 1;
+        }
+    }
+}
+
+// Moves the upper half of the victim's range to the thief's empty one.
+// Returns 0 if there was nothing to steal
+static int mvpar_steal(MvparRange* victim, MvparRange* thief) {
+    uint64_t range = __atomic_load_n(&victim->range, __ATOMIC_ACQUIRE);
+    for (;;) {
+        uint64_t begin = range & 0xffffffffu, end = range >> 32;
+        if (begin >= end) return 0;
+        uint64_t middle = end - (end - begin + 1) / 2;
+        if (__atomic_compare_exchange_n(
+                    &victim->range, &range, middle << 32 | begin,
+                    0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE
+                    )) {
+            __atomic_store_n(
+                    &thief->range, end << 32 | middle, __ATOMIC_RELEASE
+                    );
+            return 1;
+        }
+    }
+}
+
+// Runs the chunks of the current job until there is nothing left to take or
+// steal
+static void mvpar_work(MvparPool* pool, size_t self) {
+    for (;;) {
+        size_t chunk;
+        if (mvpar_take(&pool->ranges[self], &chunk)) {
+            pool->run(pool->job, chunk);
+            continue;
+        }
+        size_t k = 1;
+        while (k < pool->threads && !mvpar_steal(
+                    &pool->ranges[(self + k) % pool->threads],
+                    &pool->ranges[self]
+                    ))
+            k++;
+        if (k == pool->threads) return;
+    }
+}
+
+static void* mvpar_worker(void* arg) {
+    MvparWorker* worker = arg;
+    MvparPool* pool = worker->pool;
+    size_t self = worker->self;
+    size_t seen = 0;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (pool->generation == seen && !pool->stop)
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->stop) break;
+        seen = pool->generation;
+        pthread_mutex_unlock(&pool->lock);
+        mvpar_work(pool, self);
+        pthread_mutex_lock(&pool->lock);
+        if (--pool->busy == 0) pthread_cond_signal(&pool->done);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+// Runs run(job, c) for every chunk c in [0, count) on all the threads of the
+// pool, or on the calling thread if pool is NULL or there is a single chunk
+static void mvpar_run(
+        MvparPool* pool,
+        void (*run)(void* job, size_t chunk),
+        void* job,
+        size_t count
+        )
+{
+    if (!pool || pool->threads == 1 || count < 2) {
+        for (size_t c = 0; c < count; c++) run(job, c);
+        return;
+    }
+    pthread_mutex_lock(&pool->lock);
+    pool->run = run;
+    pool->job = job;
+    for (size_t t = 0; t < pool->threads; t++) {
+        uint64_t begin = count * t / pool->threads;
+        uint64_t end = count * (t + 1) / pool->threads;
+        pool->ranges[t].range = end << 32 | begin;
+    }
+    pool->busy = pool->threads - 1;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    mvpar_work(pool, 0);
+    pthread_mutex_lock(&pool->lock);
+    while (pool->busy) pthread_cond_wait(&pool->done, &pool->lock);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Creates a pool of the given amount of threads, the calling one included.
+// If threads is 0, uses the amount of online processors. On success, returns
+// a pointer to the pool. On failure, returns NULL.
+// UB:
+//  @ threads >= 2^32
+//  [@ current allocator is not set with mvec_setAllocator()]
+MvparPool* mvpar_create(size_t threads) {
+    if (!threads) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = online > 0 ? (size_t)online : 1;
+    }
+    mvdef MvparPool* pool = mvalloc(1, sizeof(MvparPool));
+    if (!pool) return NULL;
+    *mvlen(pool) = 1;
+    pool->threads = threads;
+    pool->generation = 0;
+    pool->busy = 0;
+    pool->stop = 0;
+    pool->workers = mvalloc(threads, sizeof(MvparWorker));
+    pool->ranges = mvalloc(threads, sizeof(MvparRange));
+    if (!pool->workers || !pool->ranges) goto fail_alloc;
+    if (pthread_mutex_init(&pool->lock, NULL)) goto fail_alloc;
+    if (pthread_cond_init(&pool->wake, NULL)) goto fail_lock;
+    if (pthread_cond_init(&pool->done, NULL)) goto fail_wake;
+    for (size_t t = 1; t < threads; t++) {
+        pool->workers[t].pool = pool;
+        pool->workers[t].self = t;
+        if (pthread_create(
+                    &pool->workers[t].thread, NULL,
+                    mvpar_worker, &pool->workers[t]
+                    )) {
+            pool->threads = t;
+            mvpar_destroy(pool);
+            return NULL;
+        }
+    }
+    return pool;
+
+fail_wake:
+    pthread_cond_destroy(&pool->wake);
+fail_lock:
+    pthread_mutex_destroy(&pool->lock);
+fail_alloc:
+    if (pool->workers) mvfree(pool->workers);
+    if (pool->ranges) mvfree(pool->ranges);
+    mvfree(pool);
+    return NULL;
+}
+
+// Stops and joins all the threads of the given pool and releases it.
+// UB:
+//  @ pool == NULL or address of not a valid pool
+//  @ a parallel function is running on the pool
+void mvpar_destroy(MvparPool* pool) {
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+    for (size_t t = 1; t < pool->threads; t++)
+        pthread_join(pool->workers[t].thread, NULL);
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+    mvfree(pool->workers);
+    mvfree(pool->ranges);
+    mvfree(pool);
+}
+
+// Returns amount of threads of the given pool, the calling one included.
+// UB: pool == NULL or address of not a valid pool
+size_t mvpar_threads(MvparPool* pool) {
+    return pool->threads;
+}
+
+static void mvpar_runForEach(void* job_p, size_t c) {
+    MvparJob* job = job_p;
+    size_t start = mvpar_chunkStart(&job->chunks, c);
+    job->range(
+            job->src + start * job->src_size,
+            mvpar_chunkLength(&job->chunks, c),
+            start,
+            job->arg
+            );
+}
+
+static void mvpar_runMap(void* job_p, size_t c) {
+    MvparJob* job = job_p;
+    size_t start = mvpar_chunkStart(&job->chunks, c);
+    job->map(
+            job->dest + start * job->dest_size,
+            job->src + start * job->src_size,
+            mvpar_chunkLength(&job->chunks, c),
+            job->arg
+            );
+}
+
+static void mvpar_runReduce(void* job_p, size_t c) {
+    MvparJob* job = job_p;
+    size_t size = job->src_size;
+    char* acc = job->partials + c * size;
+    const char* from = job->src + mvpar_chunkStart(&job->chunks, c) * size;
+    size_t count = mvpar_chunkLength(&job->chunks, c);
+    MVEC_MEMCPY_FUNCTION(acc, job->identity, size);
+    for (size_t i = 0; i < count; i++)
+        job->op(acc, from + i * size, job->arg);
+}
+
+// Scans a chunk starting from the total of the preceding ones, which is
+// stored in its partial
+static void mvpar_runScan(void* job_p, size_t c) {
+    MvparJob* job = job_p;
+    size_t size = job->src_size;
+    char* acc = job->partials + c * size;
+    char* element = job->scratch + c * size;
+    size_t start = mvpar_chunkStart(&job->chunks, c);
+    const char* from = job->src + start * size;
+    char* to = job->dest + start * size;
+    size_t count = mvpar_chunkLength(&job->chunks, c);
+    for (size_t i = 0; i < count; i++) {
+        if (job->exclusive) {
+            // The source and the destination may be the same element
+            MVEC_MEMCPY_FUNCTION(element, from + i * size, size);
+            MVEC_MEMCPY_FUNCTION(to + i * size, acc, size);
+            job->op(acc, element, job->arg);
+        } else {
+            job->op(acc, from + i * size, job->arg);
+            MVEC_MEMCPY_FUNCTION(to + i * size, acc, size);
+        }
+    }
+}
+
+// Calls func for consecutive chunks of the elements of the given mvec up to
+// its length on all the threads of the given pool, including the calling one.
+// Every element belongs to exactly one chunk. Chunks may be processed in any
+// order and simultaneously, so func must not touch the elements of the other
+// ones. If pool is NULL, processes all the chunks on the calling thread.
+// UB:
+//  @ pool is not NULL yet still not a valid pool
+//  @ mvec == NULL or address of not a valid mvector
+//  @ func == NULL or not a valid function pointer
+//  @ func calls any parallel function on the same pool
+void mvpar_forEach(
+        MvparPool* pool,
+        mvec_t* mvec,
+        rangefunc_t func,
+        void* arg
+        )
+{
+    MvparJob job = {0};
+    job.chunks = mvpar_chunk(pool, *mvlen(mvec), mvelsz(mvec), mvelsz(mvec));
+    job.src = mvec;
+    job.src_size = mvelsz(mvec);
+    job.range = func;
+    job.arg = arg;
+    mvpar_run(pool, mvpar_runForEach, &job, job.chunks.count);
+}
+
+// Calls func for consecutive chunks of the elements of src up to its length
+// and the elements of dest with the same indices on all the threads of the
+// given pool, like mvpar_forEach() does. The element sizes of the vectors may
+// differ. If the capacity of dest is less than the length of src, dest gets
+// resized first. Sets the length of dest to the length of src. dest may be
+// src itself. On success, returns a pointer to dest; its pointer's previous
+// value may get invalidated. On failure, returns NULL; dest remains untouched.
+// UB:
+//  @ pool is not NULL yet still not a valid pool
+//  @ dest or src == NULL or address of not a valid mvector
+//  @ dest and src overlap but are not the same vector
+//  @ func == NULL or not a valid function pointer
+//  @ func calls any parallel function on the same pool
+//  {@ dest is shared, i.e. mvrefs(dest) > 1. Call mvmut() first}
+mvec_t* mvpar_map(
+        MvparPool* pool,
+        mvec_t* dest,
+        mvec_t* src,
+        mapfunc_t func,
+        void* arg
+        )
+{
+    size_t length = *mvlen(src);
+    if (mvcap(dest) < length) {
+        mvec_t* grown = mvresize(dest, length);
+        if (!grown) return NULL;
+        dest = grown;
+    }
+    MvparJob job = {0};
+    job.chunks = mvpar_chunk(pool, length, mvelsz(src), mvelsz(dest));
+    job.src = src;
+    job.src_size = mvelsz(src);
+    job.dest = dest;
+    job.dest_size = mvelsz(dest);
+    job.map = func;
+    job.arg = arg;
+    mvpar_run(pool, mvpar_runMap, &job, job.chunks.count);
+    *mvlen(dest) = length;
+    return dest;
+}
+
+// Folds the elements of the given mvec up to its length with the associative
+// operation op and stores the result at the given address: result = identity
+// (op) mvec[0] (op) mvec[1] (op) ... Every chunk is folded separately on the
+// threads of the given pool, then their results get folded in order on the
+// calling thread, so op doesn't have to be commutative. identity and result
+// are mvelsz(mvec) bytes long. Returns 1 on success. On failure, returns 0;
+// result remains untouched.
+// UB:
+//  @ pool is not NULL yet still not a valid pool
+//  @ mvec == NULL or address of not a valid mvector
+//  @ result or identity is not a valid pointer to mvelsz(mvec) bytes
+//  @ op == NULL or not a valid function pointer
+//  @ identity (op) x != x for some x
+//  @ op calls any parallel function on the same pool
+//  [@ current allocator is not set with mvec_setAllocator()]
+int mvpar_reduce(
+        MvparPool* pool,
+        mvec_t* mvec,
+        void* result,
+        const void* identity,
+        opfunc_t op,
+        void* arg
+        )
+{
+    size_t size = mvelsz(mvec);
+    MvparJob job = {0};
+    job.chunks = mvpar_chunk(pool, *mvlen(mvec), size, size);
+    job.src = mvec;
+    job.src_size = size;
+    job.op = op;
+    job.arg = arg;
+    job.identity = identity;
+    mvdef char* partials = mvalloc(job.chunks.count + 1, size);
+    if (!partials) return 0;
+    job.partials = partials;
+    mvpar_run(pool, mvpar_runReduce, &job, job.chunks.count);
+    char* acc = partials + job.chunks.count * size;
+    MVEC_MEMCPY_FUNCTION(acc, identity, size);
+    for (size_t c = 0; c < job.chunks.count; c++)
+        op(acc, partials + c * size, arg);
+    MVEC_MEMCPY_FUNCTION(result, acc, size);
+    mvfree(partials);
+    return 1;
+}
+
+// Computes prefix folds of the elements of src up to its length with the
+// associative operation op and stores them in dest: dest[i] = identity (op)
+// src[0] (op) ... (op) src[i] or, if exclusive is not 0, the same without
+// src[i]. Works in two parallel passes: the first one folds every chunk, the
+// second one scans the chunks starting from the fold of the preceding ones.
+// op doesn't have to be commutative. If the capacity of dest is less than the
+// length of src, dest gets resized first. Sets the length of dest to the
+// length of src. dest may be src itself. On success, returns a pointer to
+// dest; its pointer's previous value may get invalidated. On failure, returns
+// NULL; dest remains untouched.
+// UB:
+//  @ pool is not NULL yet still not a valid pool
+//  @ dest or src == NULL or address of not a valid mvector
+//  @ dest and src overlap but are not the same vector
+//  @ mvelsz(dest) != mvelsz(src)
+//  @ identity is not a valid pointer to mvelsz(src) bytes
+//  @ op == NULL or not a valid function pointer
+//  @ identity (op) x != x for some x
+//  @ op calls any parallel function on the same pool
+//  {@ dest is shared, i.e. mvrefs(dest) > 1. Call mvmut() first}
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvec_t* mvpar_scan(
+        MvparPool* pool,
+        mvec_t* dest,
+        mvec_t* src,
+        const void* identity,
+        opfunc_t op,
+        void* arg,
+        int exclusive
+        )
+{
+    size_t length = *mvlen(src);
+    size_t size = mvelsz(src);
+    MvparJob job = {0};
+    job.chunks = mvpar_chunk(pool, length, size, size);
+    size_t count = job.chunks.count;
+    mvdef char* partials = mvalloc(2 * count + 2, size);
+    if (!partials) return NULL;
+    if (mvcap(dest) < length) {
+        mvec_t* grown = mvresize(dest, length);
+        if (!grown) {
+            mvfree(partials);
+            return NULL;
+        }
+        dest = grown;
+    }
+    job.src = src;
+    job.src_size = size;
+    job.dest = dest;
+    job.dest_size = size;
+    job.op = op;
+    job.arg = arg;
+    job.identity = identity;
+    job.partials = partials;
+    job.scratch = partials + (count + 2) * size;
+    job.exclusive = exclusive;
+    // The last chunk's fold is not needed by anyone
+    mvpar_run(pool, mvpar_runReduce, &job, count ? count - 1 : 0);
+
+    // Turn the folds of the chunks into the folds of the preceding ones
+    char* running = partials + count * size;
+    char* element = partials + (count + 1) * size;
+    MVEC_MEMCPY_FUNCTION(running, identity, size);
+    for (size_t c = 0; c < count; c++) {
+        MVEC_MEMCPY_FUNCTION(element, partials + c * size, size);
+        MVEC_MEMCPY_FUNCTION(partials + c * size, running, size);
+        if (c + 1 < count) op(running, element, arg);
+    }
+
+    mvpar_run(pool, mvpar_runScan, &job, count);
+    *mvlen(dest) = length;
+    mvfree(partials);
+    return dest;
+}
+
+#endif // MVPAR_IMPLEMENTATION
+#endif // !MVPAR_H
@@ -0,0 +1,244 @@
+// mvrcu.h - Read-copy-update publishing of monolithic vectors
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVRCU_H
+#define MVRCU_H
+
+#include <stdint.h> // uint64_t
+#include "mvec.h"
+
+// Reader slots are padded to this amount of bytes, so that readers don't
+// share cache lines
+#ifndef MVRCU_CACHE_LINE
+#define MVRCU_CACHE_LINE 64
+#endif // !MVRCU_CACHE_LINE
+
+// Returned by mvrcu_register() when all the reader slots are taken
+#define MVRCU_NONE ((size_t)-1)
+
+// A reader slot. Its epoch is the global epoch at the moment the reader
+// entered its read section, or 0 outside of read sections
+typedef struct mvrcu_reader_t {
+    uint64_t epoch;
+    uint64_t taken;
+    char padding[MVRCU_CACHE_LINE - 2 * sizeof(uint64_t)];
+} MvrcuReader;
+
+// A replaced version waiting for the readers of the epoch it was replaced in
+// and of the earlier ones to leave
+typedef struct mvrcu_retired_t {
+    mvdef void* mvec;
+    uint64_t epoch;
+} MvrcuRetired;
+
+// Holds the published version of a vector. Readers get it in read sections
+// without locking; the writer replaces it with a new version and the old one
+// is freed with mvfree() [, i.e. with the free function stored in it,] once
+// no reader may still use it
+typedef struct mvrcu_domain_t {
+    mvdef void* published;
+    uint64_t epoch;                 // Starts with 1
+    mvdef MvrcuRetired* retired;    // Only touched by the writer
+    mvdef MvrcuReader* readers;
+} MvrcuDomain;
+
+// Use this typedef for publishing domains. Release them with mvrcu_destroy()
+typedef MvrcuDomain mvrcu_t;
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+mvrcu_t* mvrcu_create(mvec_t* mvec, size_t readers);
+void mvrcu_destroy(mvrcu_t* rcu);
+size_t mvrcu_register(mvrcu_t* rcu);
+void mvrcu_unregister(mvrcu_t* rcu, size_t reader);
+static inline mvec_t* mvrcu_enter(mvrcu_t* rcu, size_t reader);
+static inline void mvrcu_leave(mvrcu_t* rcu, size_t reader);
+static inline mvec_t* mvrcu_current(mvrcu_t* rcu);
+int mvrcu_publish(mvrcu_t* rcu, mvec_t* mvec);
+size_t mvrcu_reclaim(mvrcu_t* rcu);
+void mvrcu_synchronize(mvrcu_t* rcu);
+
+// Enters a read section of the given reader slot and returns the published
+// version of the vector (possibly NULL). The version stays valid until
+// mvrcu_leave() with the same slot. Costs one atomic store and two loads.
+// UB:
+//  @ rcu == NULL or address of not a valid publishing domain
+//  @ reader is not a slot registered by the calling thread
+//  @ the slot is already in a read section
+//  @ the version is modified
+static inline mvec_t* mvrcu_enter(mvrcu_t* rcu, size_t reader) {
+    uint64_t epoch = __atomic_load_n(&rcu->epoch, __ATOMIC_ACQUIRE);
+    __atomic_store_n(&rcu->readers[reader].epoch, epoch, __ATOMIC_SEQ_CST);
+    return __atomic_load_n(&rcu->published, __ATOMIC_SEQ_CST);
+}
+
+// Leaves the read section of the given reader slot. The version returned by
+// mvrcu_enter() must not be used after that.
+// UB:
+//  @ rcu == NULL or address of not a valid publishing domain
+//  @ reader is not a slot registered by the calling thread
+static inline void mvrcu_leave(mvrcu_t* rcu, size_t reader) {
+    __atomic_store_n(&rcu->readers[reader].epoch, 0, __ATOMIC_RELEASE);
+}
+
+// Returns the published version of the vector for the writer, which may read
+// it outside of read sections.
+// UB: rcu == NULL or address of not a valid publishing domain
+static inline mvec_t* mvrcu_current(mvrcu_t* rcu) {
+    return __atomic_load_n(&rcu->published, __ATOMIC_ACQUIRE);
+}
+
+#ifdef MVRCU_IMPLEMENTATION
+#undef MVRCU_IMPLEMENTATION
+
+#include <sched.h> // sched_yield
+
+// Allocates a new publishing domain with the given published version of a
+// vector (possibly NULL) and the given amount of reader slots.
+// On success, returns a pointer to the new domain, which now owns the vector.
+// On failure, returns NULL.
+// [UB: current allocator is not set with mvec_setAllocator()]
+mvrcu_t* mvrcu_create(mvec_t* mvec, size_t readers) {
+    mvdef mvrcu_t* rcu = mvalloc(1, sizeof(mvrcu_t));
+    if (!rcu) return NULL;
+    *mvlen(rcu) = 1;
+    rcu->retired = mvalloc(4, sizeof(MvrcuRetired));
+    rcu->readers = mvcalloc(readers ? readers : 1, sizeof(MvrcuReader));
+    if (!rcu->retired || !rcu->readers) {
+        if (rcu->retired) mvfree(rcu->retired);
+        if (rcu->readers) mvfree(rcu->readers);
+        mvfree(rcu);
+        return NULL;
+    }
+    *mvlen(rcu->readers) = readers;
+    rcu->published = mvec;
+    rcu->epoch = 1;
+    return rcu;
+}
+
+// Deallocates the given publishing domain together with the published version
+// and all the replaced ones.
+// UB:
+//  @ rcu == NULL or address of not a valid publishing domain
+//  @ some of its slots are in read sections
+void mvrcu_destroy(mvrcu_t* rcu) {
+    for (size_t i = 0; i < *mvlen(rcu->retired); i++)
+        mvfree(rcu->retired[i].mvec);
+    if (rcu->published) mvfree(rcu->published);
+    mvfree(rcu->retired);
+    mvfree(rcu->readers);
+    mvfree(rcu);
+}
+
+// Takes a free reader slot of the given domain. Every reading thread needs
+// its own slot. Returns the slot. If all of them are taken, returns
+// MVRCU_NONE.
+// UB: rcu == NULL or address of not a valid publishing domain
+size_t mvrcu_register(mvrcu_t* rcu) {
+    for (size_t i = 0; i < *mvlen(rcu->readers); i++) {
+        uint64_t free_slot = 0;
+        if (__atomic_compare_exchange_n(
+                    &rcu->readers[i].taken, &free_slot, 1, 0,
+                    __ATOMIC_ACQUIRE, __ATOMIC_RELAXED
+                    ))
+            return i;
+    }
+    return MVRCU_NONE;
+}
+
+// Gives back the given reader slot of the given domain.
+// UB:
+//  @ rcu == NULL or address of not a valid publishing domain
+//  @ reader is not a slot registered by the calling thread
+//  @ the slot is in a read section
+void mvrcu_unregister(mvrcu_t* rcu, size_t reader) {
+    __atomic_store_n(&rcu->readers[reader].taken, 0, __ATOMIC_RELEASE);
+}
+
+// Frees the replaced versions of the vector in the given domain which no
+// reader may use anymore. Never waits for the readers. Returns amount of
+// the replaced versions left.
+// UB:
+//  @ rcu == NULL or address of not a valid publishing domain
+//  @ called concurrently with mvrcu_publish() or itself
+size_t mvrcu_reclaim(mvrcu_t* rcu) {
+    uint64_t oldest = UINT64_MAX;
+    for (size_t i = 0; i < *mvlen(rcu->readers); i++) {
+        uint64_t epoch =
+            __atomic_load_n(&rcu->readers[i].epoch, __ATOMIC_SEQ_CST);
+        if (epoch && epoch < oldest) oldest = epoch;
+    }
+    // Readers that entered in a later epoch than the one a version was
+    // replaced in have got one of the next versions
+    size_t left = 0;
+    for (size_t i = 0; i < *mvlen(rcu->retired); i++) {
+        if (rcu->retired[i].epoch < oldest) mvfree(rcu->retired[i].mvec);
+        else rcu->retired[left++] = rcu->retired[i];
+    }
+    *mvlen(rcu->retired) = left;
+    return left;
+}
+
+// Makes the given vector the published version in the given domain, which
+// now owns it. The readers entering read sections after that get it, and the
+// ones in read sections keep using the previous version, which is freed later.
+// Then frees the replaced versions nobody uses anymore. The vector must not
+// be modified after the call. Returns 1 on success. On failure, returns 0;
+// the published version remains untouched.
+// UB:
+//  @ rcu == NULL or address of not a valid publishing domain
+//  @ mvec is not a valid mvec or NULL
+//  @ mvec is the published version or one of the replaced ones
+//  @ called concurrently with mvrcu_reclaim() or itself
+int mvrcu_publish(mvrcu_t* rcu, mvec_t* mvec) {
+    size_t length = *mvlen(rcu->retired);
+    if (length == mvcap(rcu->retired)) {
+        mvdef MvrcuRetired* retired = mvresize(rcu->retired, length * 2);
+        if (!retired) return 0;
+        rcu->retired = retired;
+    }
+    mvec_t* old = __atomic_exchange_n(&rcu->published, mvec, __ATOMIC_SEQ_CST);
+    uint64_t epoch = __atomic_fetch_add(&rcu->epoch, 1, __ATOMIC_SEQ_CST);
+    if (old) {
+        rcu->retired[length].mvec = old;
+        rcu->retired[length].epoch = epoch;
+        *mvlen(rcu->retired) = length + 1;
+    }
+    mvrcu_reclaim(rcu);
+    return 1;
+}
+
+// Waits until all the replaced versions of the vector in the given domain are
+// freed, i.e. until every read section started before the call ends.
+// UB:
+//  @ rcu == NULL or address of not a valid publishing domain
+//  @ called concurrently with mvrcu_publish() or mvrcu_reclaim()
+//  @ called from a read section
+void mvrcu_synchronize(mvrcu_t* rcu) {
+    while (mvrcu_reclaim(rcu)) sched_yield();
+}
+
+#endif // MVRCU_IMPLEMENTATION
+#endif // !MVRCU_H
@@ -0,0 +1,316 @@
+// mvshm.h - Monolithic vectors shared between processes
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVSHM_H
+#define MVSHM_H
+
+#include <stdint.h> // uint32_t, uint64_t
+#include "mvec.h"
+
+// The implementation uses POSIX.1-2008 functions (shm_open(), ftruncate(),
+// ...). With strict -std=c99 or -std=c11, define _POSIX_C_SOURCE as 200809L
+// or greater before including any header, otherwise they aren't declared
+
+// The first bytes of every shared memory segment holding an mvec
+#define MVSHM_MAGIC "MVSHMEM1"
+
+// Data of shared vectors is aligned to this amount of bytes
+#define MVSHM_ALIGNMENT 64
+
+// The beginning of a shared memory segment. It's followed by MvecHeader and
+// the data of the vector at offset data_offset. The segment only grows: on
+// growth, the writer enlarges it, remaps it and increments the generation, so
+// that the readers know they should remap it too
+typedef struct mvshm_segment_t {
+    char magic[8];
+    uint32_t header_size;   // sizeof(MvecHeader) of the writer
+    uint32_t data_offset;   // 0 until the segment is initialized
+    uint64_t generation;
+} MvshmSegment;
+
+// A process-local view of a shared memory segment. There is one writer, the
+// process that created the segment, and any amount of readers
+typedef struct mvshm_header_t {
+    mvdef void* mvec;       // Inside the mapping
+    MvshmSegment* segment;  // The mapping itself
+    size_t map_size;
+    uint64_t generation;    // Of the mapping
+    int fd;
+    int writer;
+} MvshmHeader;
+
+// Use this typedef for handles of shared vectors. Release them with
+// mvshm_close()
+typedef MvshmHeader mvshm_t;
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+mvshm_t* mvec_shmCreate(
+        const char* name,
+        size_t capacity,
+        size_t element_size
+        );
+mvshm_t* mvec_shmOpen(const char* name);
+void mvshm_close(mvshm_t* shm);
+int mvshm_unlink(const char* name);
+int mvshm_resize(mvshm_t* shm, size_t capacity);
+int mvshm_push(mvshm_t* shm, const void* value);
+void mvshm_publish(mvshm_t* shm, size_t length);
+size_t mvshm_sync(mvshm_t* shm);
+static inline mvec_t* mvshm_mvec(mvshm_t* shm);
+
+// Returns the shared vector as seen by this process. It's an ordinary mvec
+// for reading, but for readers *mvlen() may already count elements the writer
+// has put past this process' mapping. Readers must use the length returned by
+// mvshm_sync() instead, e.g. pass it to mvcopy() as the capacity. The writer
+// may also modify the elements below the capacity directly and then call
+// mvshm_publish(). The address stays valid until the next mvshm_resize(),
+// mvshm_push() or mvshm_sync().
+// UB:
+//  @ shm == NULL or address of not a valid shared vector handle
+//  @ the returned vector is passed to mvresize(), mvfree() or other functions
+//    changing its capacity or freeing it
+//  @ readers write into the returned vector
+//  @ readers access elements at or past the length returned by mvshm_sync()
+static inline mvec_t* mvshm_mvec(mvshm_t* shm) {
+    return shm->mvec;
+}
+
+#ifdef MVSHM_IMPLEMENTATION
+#undef MVSHM_IMPLEMENTATION
+
+#include <fcntl.h> // O_* constants
+#include <stdio.h> // snprintf
+#include <string.h> // memcpy, memcmp, memset
+#include <sys/mman.h> // shm_open, shm_unlink, mmap, munmap
+#include <sys/stat.h> // fstat
+#include <unistd.h> // ftruncate, close, getpid
+
+// Maps size bytes of the segment of the given handle in place of its current
+// mapping, if any. Returns 1 on success. On failure, returns 0; the handle
+// remains untouched
+static int mvshm_map(mvshm_t* shm, size_t size) {
+    int prot = shm->writer ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* map = mmap(NULL, size, prot, MAP_SHARED, shm->fd, 0);
+    if (map == MAP_FAILED) return 0;
+    if (shm->segment) munmap(shm->segment, shm->map_size);
+    shm->segment = (MvshmSegment*)map;
+    shm->map_size = size;
+    shm->mvec = (char*)map
+        + __atomic_load_n(&shm->segment->data_offset, __ATOMIC_ACQUIRE);
+    return 1;
+}
+
+// Amount of elements fitting into the mapping of the given handle
+static size_t mvshm_mappedCapacity(mvshm_t* shm) {
+    return (shm->map_size - shm->segment->data_offset) / mvelsz(shm->mvec);
+}
+
+// Creates a shared memory segment with the given name (see shm_open()) and
+// puts a new vector with given capacity of elements with element_size each
+// into it. Sets length to 0. The calling process becomes the only writer of
+// the vector. If name is NULL, the segment is anonymous: it's only shared
+// with the processes forked after this call, which inherit the handle.
+// On success, returns the handle of the vector. On failure (including the
+// case when a segment with the given name already exists), returns NULL.
+// UB: element_size == 0
+mvshm_t* mvec_shmCreate(
+        const char* name,
+        size_t capacity,
+        size_t element_size
+        )
+{
+    mvdef mvshm_t* shm = mvalloc(1, sizeof(mvshm_t));
+    if (!shm) return NULL;
+    *mvlen(shm) = 1;
+    char anonymous[64];
+    if (!name) {
+        static uint64_t counter = 0;
+        snprintf(anonymous, sizeof(anonymous), "/mvshm-%ld-%llu",
+                (long)getpid(), (unsigned long long)
+                __atomic_fetch_add(&counter, 1, __ATOMIC_RELAXED));
+    }
+    const char* path = name ? name : anonymous;
+    shm->fd = shm_open(path, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (shm->fd < 0) {
+        mvfree(shm);
+        return NULL;
+    }
+    if (!name) shm_unlink(path);
+    shm->segment = NULL;
+    shm->generation = 0;
+    shm->writer = 1;
+    size_t offset = sizeof(MvshmSegment) + sizeof(MvecHeader);
+    offset = (offset + MVSHM_ALIGNMENT - 1) / MVSHM_ALIGNMENT * MVSHM_ALIGNMENT;
+    size_t size = offset + capacity * element_size;
+    if (ftruncate(shm->fd, size) || !mvshm_map(shm, size)) {
+        if (name) shm_unlink(name);
+        close(shm->fd);
+        mvfree(shm);
+        return NULL;
+    }
+    MvshmSegment* segment = shm->segment;
+    memcpy(segment->magic, MVSHM_MAGIC, 8);
+    segment->header_size = sizeof(MvecHeader);
+    segment->generation = 0;
+    shm->mvec = (char*)segment + offset;
+    MvecHeader* header = mvhead(shm->mvec);
+    memset(header, 0, sizeof(MvecHeader));
+#ifdef MVEC_SHARED
+    header->refcount = 1;
+#endif // MVEC_SHARED
+    header->capacity = capacity;
+    header->element_size = element_size;
+    // Readers don't touch the segment until its data offset is set
+    __atomic_store_n(&segment->data_offset, offset, __ATOMIC_RELEASE);
+    return shm;
+}
+
+// Opens the shared vector created with mvec_shmCreate() under the given name
+// by another process (or by this one) for reading. All the processes must
+// compile mvec.h with the same MVEC_* macros.
+// On success, returns the handle of the vector. On failure (including the
+// case when the segment doesn't hold a compatible vector), returns NULL.
+mvshm_t* mvec_shmOpen(const char* name) {
+    mvdef mvshm_t* shm = mvalloc(1, sizeof(mvshm_t));
+    if (!shm) return NULL;
+    *mvlen(shm) = 1;
+    shm->fd = shm_open(name, O_RDONLY, 0);
+    if (shm->fd < 0) {
+        mvfree(shm);
+        return NULL;
+    }
+    shm->segment = NULL;
+    shm->writer = 0;
+    struct stat st;
+    size_t offset = sizeof(MvshmSegment) + sizeof(MvecHeader);
+    if (fstat(shm->fd, &st) || (size_t)st.st_size < offset) goto fail;
+    if (!mvshm_map(shm, sizeof(MvshmSegment))) goto fail;
+    MvshmSegment* segment = shm->segment;
+    if (!__atomic_load_n(&segment->data_offset, __ATOMIC_ACQUIRE)) goto fail;
+    if (memcmp(segment->magic, MVSHM_MAGIC, 8)) goto fail;
+    if (segment->header_size != sizeof(MvecHeader)) goto fail;
+    // The generation is read before the size, since the size only grows
+    shm->generation = __atomic_load_n(&segment->generation, __ATOMIC_ACQUIRE);
+    if (fstat(shm->fd, &st) || !mvshm_map(shm, st.st_size)) goto fail;
+    return shm;
+fail:
+    if (shm->segment) munmap(shm->segment, shm->map_size);
+    close(shm->fd);
+    mvfree(shm);
+    return NULL;
+}
+
+// Unmaps the shared vector of the given handle and deallocates the handle.
+// The segment itself persists until mvshm_unlink() and the last process
+// closing it.
+// UB: shm == NULL or address of not a valid shared vector handle
+void mvshm_close(mvshm_t* shm) {
+    munmap(shm->segment, shm->map_size);
+    close(shm->fd);
+    mvfree(shm);
+}
+
+// Removes the given name of a shared vector, so that it can't be opened
+// anymore. The processes which have opened it keep working with it.
+// Returns 1 on success. On failure, returns 0.
+int mvshm_unlink(const char* name) {
+    return !shm_unlink(name);
+}
+
+// Grows the shared vector of the given handle, so that it can hold at least
+// capacity elements. Doesn't shrink it, since the readers might still use
+// the elements. Readers keep working with their mappings and remap the vector
+// on their next mvshm_sync(). Returns 1 on success. On failure, returns 0;
+// the vector remains untouched.
+// UB:
+//  @ shm == NULL or address of not a valid shared vector handle
+//  @ the calling process is not the writer
+int mvshm_resize(mvshm_t* shm, size_t capacity) {
+    if (capacity <= mvcap(shm->mvec)) return 1;
+    size_t size = shm->segment->data_offset + capacity * mvelsz(shm->mvec);
+    if (ftruncate(shm->fd, size) || !mvshm_map(shm, size)) return 0;
+    __atomic_store_n(&mvhead(shm->mvec)->capacity, capacity, __ATOMIC_RELAXED);
+    shm->generation++;
+    __atomic_store_n(&shm->segment->generation, shm->generation,
+            __ATOMIC_RELEASE);
+    return 1;
+}
+
+// Sets length of the shared vector of the given handle, making the elements
+// below it visible to the readers. Write the elements first.
+// UB:
+//  @ shm == NULL or address of not a valid shared vector handle
+//  @ the calling process is not the writer
+//  @ length > mvcap(mvshm_mvec(shm))
+void mvshm_publish(mvshm_t* shm, size_t length) {
+    __atomic_store_n(mvlen(shm->mvec), length, __ATOMIC_RELEASE);
+}
+
+// Appends the value of mvelsz(mvshm_mvec(shm)) bytes at the given address to
+// the shared vector of the given handle and publishes it. Doubles the
+// capacity if the vector is full. Returns 1 on success. On failure, returns 0;
+// the vector remains untouched.
+// UB:
+//  @ shm == NULL or address of not a valid shared vector handle
+//  @ the calling process is not the writer
+//  @ value is not a valid pointer to mvelsz(mvshm_mvec(shm)) bytes
+//  @ value points inside the vector
+int mvshm_push(mvshm_t* shm, const void* value) {
+    size_t length = *mvlen(shm->mvec);
+    size_t capacity = mvcap(shm->mvec);
+    if (length == capacity && !mvshm_resize(shm, capacity ? capacity * 2 : 1))
+        return 0;
+    size_t element_size = mvelsz(shm->mvec);
+    MVEC_MEMCPY_FUNCTION((char*)shm->mvec + length * element_size, value,
+            element_size);
+    mvshm_publish(shm, length + 1);
+    return 1;
+}
+
+// Remaps the shared vector of the given handle if the writer has grown it
+// since the last call. Returns amount of elements published by the writer
+// which this process can read, i.e. use it instead of *mvlen() and re-read
+// mvshm_mvec(shm) after the call. Never blocks the writer. If remapping
+// fails, keeps the old mapping, and the returned length is limited by it.
+// UB: shm == NULL or address of not a valid shared vector handle
+size_t mvshm_sync(mvshm_t* shm) {
+    uint64_t generation =
+        __atomic_load_n(&shm->segment->generation, __ATOMIC_ACQUIRE);
+    if (generation != shm->generation) {
+        // The segment is grown before the generation changes, so the mapping
+        // may already cover it, e.g. if it was opened during the growth
+        struct stat st;
+        if (!fstat(shm->fd, &st) && ((size_t)st.st_size <= shm->map_size
+                    || mvshm_map(shm, st.st_size)))
+            shm->generation = generation;
+    }
+    size_t length = __atomic_load_n(mvlen(shm->mvec), __ATOMIC_ACQUIRE);
+    size_t mapped = mvshm_mappedCapacity(shm);
+    return length < mapped ? length : mapped;
+}
+
+#endif // MVSHM_IMPLEMENTATION
+#endif // !MVSHM_H
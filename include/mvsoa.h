@@ -0,0 +1,305 @@
+// mvsoa.h - Structure-of-arrays monolithic vector
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVSOA_H
+#define MVSOA_H
+
+#include "mvec.h"
+
+// Every column starts at an address that is a multiple of this value. Must be
+// a power of two. Defaults to a typical cache line size
+#ifndef MVSOA_ALIGNMENT
+#define MVSOA_ALIGNMENT 64
+#endif // !MVSOA_ALIGNMENT
+
+typedef struct mvsoa_column_t {
+    size_t element_size;
+    size_t offset; // in bytes, from the start of MvsoaHeader
+} MvsoaColumn;
+
+// A multi-column vector lives in the data of a byte mvec, so it is allocated,
+// resized and freed by the core functions [with the allocator it was
+// allocated with]. All the columns share a single length and capacity
+typedef struct mvsoa_header_t {
+    size_t length;
+    size_t capacity;
+    size_t columns;
+    MvsoaColumn column[];
+} MvsoaHeader;
+
+// Use this typedef for multi-column vectors. Release them with mvfree()
+typedef MvsoaHeader mvsoa_t;
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+mvsoa_t* mvsoa_alloc(
+        size_t capacity,
+        size_t columns,
+        const size_t* element_sizes
+        );
+mvsoa_t* mvsoa_resize(mvsoa_t* soa, size_t new_capacity);
+mvsoa_t* mvsoa_push(mvsoa_t* soa, const void* const* values);
+void mvsoa_shift(mvsoa_t* soa, size_t index, ptrdiff_t offset);
+void mvsoa_erase(mvsoa_t* soa, size_t index, size_t count);
+static inline size_t* mvsoa_len(mvsoa_t* soa);
+static inline size_t mvsoa_cap(mvsoa_t* soa);
+static inline size_t mvsoa_cols(mvsoa_t* soa);
+static inline size_t mvsoa_elsz(mvsoa_t* soa, size_t column);
+static inline void* mvsoa_col(mvsoa_t* soa, size_t column);
+
+// Returns address of the length shared by all columns of the given vector.
+// UB:
+//  @ soa == NULL or address of not a valid multi-column vector
+//  @ Setting length larger than capacity
+static inline size_t* mvsoa_len(mvsoa_t* soa) {
+    return &soa->length;
+}
+
+// Returns capacity of the given vector. Consider modifying it via
+// mvsoa_resize().
+// UB: soa == NULL or address of not a valid multi-column vector
+static inline size_t mvsoa_cap(mvsoa_t* soa) {
+    return soa->capacity;
+}
+
+// Returns amount of columns of the given vector.
+// UB: soa == NULL or address of not a valid multi-column vector
+static inline size_t mvsoa_cols(mvsoa_t* soa) {
+    return soa->columns;
+}
+
+// Returns size of a single element of the given column in bytes.
+// UB:
+//  @ soa == NULL or address of not a valid multi-column vector
+//  @ column >= mvsoa_cols(soa)
+static inline size_t mvsoa_elsz(mvsoa_t* soa, size_t column) {
+    return soa->column[column].element_size;
+}
+
+// Returns a MVSOA_ALIGNMENT-aligned pointer to the first element of the given
+// column. It gets invalidated by every function that may reallocate the
+// vector, i.e. mvsoa_resize() and mvsoa_push().
+// UB:
+//  @ soa == NULL or address of not a valid multi-column vector
+//  @ column >= mvsoa_cols(soa)
+static inline void* mvsoa_col(mvsoa_t* soa, size_t column) {
+    return (char*)soa + soa->column[column].offset;
+}
+
+#ifdef MVSOA_IMPLEMENTATION
+#undef MVSOA_IMPLEMENTATION
+
+#include <stdint.h> // uintptr_t
+#include <string.h> // memcpy, memmove
+
+static inline size_t mvsoa_alignUp(size_t bytes) {
+    return (bytes + MVSOA_ALIGNMENT - 1) & ~(size_t)(MVSOA_ALIGNMENT - 1);
+}
+
+// Offset of the first column for a header placed at the given address
+static inline size_t mvsoa_firstOffset(MvsoaHeader* soa) {
+    uintptr_t base = (uintptr_t)soa;
+    uintptr_t first = base + sizeof(MvsoaHeader)
+        + soa->columns * sizeof(MvsoaColumn);
+    return mvsoa_alignUp(first) - base;
+}
+
+// Physical size of the vector's data in bytes. Reserves room for the worst
+// case alignment padding, so any address returned by the allocator fits
+static size_t mvsoa_bytes(
+        size_t capacity,
+        size_t columns,
+        const MvsoaColumn* column,
+        const size_t* element_sizes
+        )
+{
+    size_t bytes = sizeof(MvsoaHeader) + columns * sizeof(MvsoaColumn)
+        + MVSOA_ALIGNMENT - 1;
+    for (size_t i = 0; i < columns; i++)
+        bytes += mvsoa_alignUp(capacity
+                * (column ? column[i].element_size : element_sizes[i]));
+    return bytes;
+}
+
+// Moves the columns to the positions they are supposed to take for the given
+// capacity at the vector's current address. The columns are ordered the same
+// way in both layouts, so moving the ones going towards the start in
+// ascending order and then the ones going towards the end in descending order
+// never overwrites data that has not been moved yet.
+// UB: soa->length > new_capacity
+static void mvsoa_relayout(MvsoaHeader* soa, size_t new_capacity) {
+    size_t at = mvsoa_firstOffset(soa);
+    for (size_t i = 0; i < soa->columns; i++) {
+        MvsoaColumn* col = &soa->column[i];
+        if (at < col->offset) {
+            MVEC_MEMMOVE_FUNCTION(
+                    (char*)soa + at,
+                    (char*)soa + col->offset,
+                    soa->length * col->element_size
+                   );
+            col->offset = at;
+        }
+        at += mvsoa_alignUp(new_capacity * col->element_size);
+    }
+    for (size_t i = soa->columns; i-- > 0;) {
+        MvsoaColumn* col = &soa->column[i];
+        at -= mvsoa_alignUp(new_capacity * col->element_size);
+        if (at > col->offset) {
+            MVEC_MEMMOVE_FUNCTION(
+                    (char*)soa + at,
+                    (char*)soa + col->offset,
+                    soa->length * col->element_size
+                   );
+            col->offset = at;
+        }
+    }
+}
+
+// Allocates a new multi-column vector with given capacity and given amount of
+// columns with element_sizes[i] bytes per element of i-th column. Uses a
+// single mvalloc() for the header and all the columns. Sets length to 0. On
+// success, returns a pointer to the newly allocated vector. On failure,
+// returns NULL.
+// UB:
+//  @ element_sizes does not point to at least columns values
+//  @ reading from columns' contents before initialization
+//  @ accessing columns' contents beyond the capacity
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvsoa_t* mvsoa_alloc(
+        size_t capacity,
+        size_t columns,
+        const size_t* element_sizes
+        )
+{
+    size_t bytes = mvsoa_bytes(capacity, columns, NULL, element_sizes);
+    mvsoa_t* soa = mvalloc(bytes, 1);
+    if (!soa) return NULL;
+    *mvlen(soa) = bytes;
+    soa->length = 0;
+    soa->capacity = capacity;
+    soa->columns = columns;
+    size_t at = mvsoa_firstOffset(soa);
+    for (size_t i = 0; i < columns; i++) {
+        soa->column[i].element_size = element_sizes[i];
+        soa->column[i].offset = at;
+        at += mvsoa_alignUp(capacity * element_sizes[i]);
+    }
+    return soa;
+}
+
+// Resizes all the columns of the given vector to the given new_capacity with a
+// single mvresize(). If length exceeds new_capacity, it gets leveled to it and
+// all the trimmed data is lost. On success, returns a pointer to the resized
+// vector; its pointer's previous value and all the column pointers get
+// invalidated. On failure, returns NULL; the state and the data of the given
+// vector remain untouched. Shrinking never fails: if the allocator refuses to
+// shrink the memory chunk, the vector just keeps the larger one.
+// UB: soa == NULL or address of not a valid multi-column vector
+mvsoa_t* mvsoa_resize(mvsoa_t* soa, size_t new_capacity) {
+    size_t bytes = mvsoa_bytes(new_capacity, soa->columns, soa->column, NULL);
+    if (new_capacity < soa->capacity) {
+        if (soa->length > new_capacity) soa->length = new_capacity;
+        mvsoa_relayout(soa, new_capacity);
+        soa->capacity = new_capacity;
+        mvsoa_t* shrunk = mvresize(soa, bytes);
+        if (!shrunk) return soa;
+        // The allocator may have moved the chunk to a differently aligned
+        // address
+        mvsoa_relayout(shrunk, new_capacity);
+        return shrunk;
+    }
+    mvsoa_t* grown = mvresize(soa, bytes);
+    if (!grown) return NULL;
+    *mvlen(grown) = bytes;
+    mvsoa_relayout(grown, new_capacity);
+    grown->capacity = new_capacity;
+    return grown;
+}
+
+// Appends a row to the given vector, copying mvsoa_elsz(soa, i) bytes from
+// values[i] to the end of i-th column. If the vector is full, doubles its
+// capacity first. On success, returns a pointer to the vector; its pointer's
+// previous value and all the column pointers may get invalidated. On failure,
+// returns NULL; the state and the data of the given vector remain untouched.
+// UB:
+//  @ soa == NULL or address of not a valid multi-column vector
+//  @ values does not point to mvsoa_cols(soa) valid pointers
+//  @ any of values[i] points inside the vector
+mvsoa_t* mvsoa_push(mvsoa_t* soa, const void* const* values) {
+    if (soa->length == soa->capacity) {
+        mvsoa_t* grown = mvsoa_resize(
+                soa,
+                soa->capacity ? soa->capacity * 2 : 1
+                );
+        if (!grown) return NULL;
+        soa = grown;
+    }
+    for (size_t i = 0; i < soa->columns; i++) {
+        size_t element_size = soa->column[i].element_size;
+        MVEC_MEMCPY_FUNCTION(
+                (char*)mvsoa_col(soa, i) + soa->length * element_size,
+                values[i],
+                element_size
+              );
+    }
+    soa->length += 1;
+    return soa;
+}
+
+// Works the same as mvshift() applied to every column of the given vector at
+// once. Adds offset to the shared length.
+// UB:
+//  @ soa == NULL or address of not a valid multi-column vector
+//  @ !(0 <= index && index < *mvsoa_len(soa))
+//  @ index+offset < 0
+//  @ *mvsoa_len(soa)+offset > mvsoa_cap(soa)
+void mvsoa_shift(mvsoa_t* soa, size_t index, ptrdiff_t offset) {
+    for (size_t i = 0; i < soa->columns; i++) {
+        size_t element_size = soa->column[i].element_size;
+        char* col = mvsoa_col(soa, i);
+        MVEC_MEMMOVE_FUNCTION(
+                col + (index + offset) * element_size,
+                col + index * element_size,
+                (soa->length - index) * element_size
+               );
+    }
+    soa->length += offset;
+}
+
+// Removes count rows starting from the given index from every column of the
+// given vector, shifting the following rows towards the start.
+// UB:
+//  @ soa == NULL or address of not a valid multi-column vector
+//  @ index + count > *mvsoa_len(soa)
+void mvsoa_erase(mvsoa_t* soa, size_t index, size_t count) {
+    if (index + count == soa->length) {
+        soa->length = index;
+        return;
+    }
+    mvsoa_shift(soa, index + count, -(ptrdiff_t)count);
+}
+
+#endif // MVSOA_IMPLEMENTATION
+#endif // !MVSOA_H
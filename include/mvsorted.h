@@ -0,0 +1,516 @@
+// mvsorted.h - Sorted monolithic vectors: flat sets and maps
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVSORTED_H
+#define MVSORTED_H
+
+#include <stdint.h> // int32_t, uintptr_t
+
+#include "mvec.h"
+
+// A sorted mvec is an ordinary mvec whose elements are kept in ascending order
+// by a comparator, without equal elements. It works as a flat set or, if the
+// comparator looks at a key stored in each element, as a flat map. Functions
+// below take the comparator used to sort the vector and the address of an
+// element-sized key (only the part the comparator looks at has to be set).
+// Functions with the I32 suffix are fast paths for vectors of int32_t sorted
+// in ascending order and do not take a comparator.
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+size_t mvsorted_lowerBound(mvec_t* mvec, const void* key, cmpfunc_t cmp);
+size_t mvsorted_upperBound(mvec_t* mvec, const void* key, cmpfunc_t cmp);
+size_t mvsorted_find(mvec_t* mvec, const void* key, cmpfunc_t cmp);
+mvec_t* mvsorted_insert(mvec_t* mvec, const void* element, cmpfunc_t cmp);
+int mvsorted_erase(mvec_t* mvec, const void* key, cmpfunc_t cmp);
+mvec_t* mvsorted_merge(
+        mvec_t* mvec,
+        const void* batch,
+        size_t quantity,
+        cmpfunc_t cmp
+        );
+mvec_t* mvsorted_union(mvec_t* a, mvec_t* b, cmpfunc_t cmp);
+mvec_t* mvsorted_intersection(mvec_t* a, mvec_t* b, cmpfunc_t cmp);
+
+mvec_t* mvsorted_toEytzinger(mvec_t* mvec);
+size_t mvsorted_eytzingerLowerBound(
+        mvec_t* eytzinger,
+        const void* key,
+        cmpfunc_t cmp
+        );
+
+size_t mvsorted_lowerBoundI32(mvdef int32_t* mvec, int32_t key);
+size_t mvsorted_upperBoundI32(mvdef int32_t* mvec, int32_t key);
+size_t mvsorted_eytzingerLowerBoundI32(mvdef int32_t* eytzinger, int32_t key);
+mvec_t* mvsorted_unionI32(mvdef int32_t* a, mvdef int32_t* b);
+mvec_t* mvsorted_intersectionI32(mvdef int32_t* a, mvdef int32_t* b);
+
+#ifdef MVSORTED_IMPLEMENTATION
+#undef MVSORTED_IMPLEMENTATION
+
+#include <string.h> // memcpy, memmove
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h> // SSE2 intrinsics
+#define MVSORTED_SSE2
+#endif // __SSE2__ || _M_X64
+
+// Returns the index of the first element of the given sorted mvec that is not
+// less than the given key, or its length if there is no such element. The
+// search loop has no data-dependent branches: the compiler turns the
+// selection into a conditional move, so mispredictions do not stall it.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not sorted by cmp
+size_t mvsorted_lowerBound(mvec_t* mvec, const void* key, cmpfunc_t cmp) {
+    size_t element_size = mvelsz(mvec);
+    size_t n = *mvlen(mvec);
+    if (!n) return 0;
+    const char* base = mvec;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = cmp(base + half * element_size, key) < 0
+            ? base + half * element_size : base;
+        n -= half;
+    }
+    size_t index = (size_t)(base - (const char*)mvec) / element_size;
+    return index + (cmp(base, key) < 0);
+}
+
+// Returns the index of the first element of the given sorted mvec that is
+// greater than the given key, or its length if there is no such element.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not sorted by cmp
+size_t mvsorted_upperBound(mvec_t* mvec, const void* key, cmpfunc_t cmp) {
+    size_t element_size = mvelsz(mvec);
+    size_t n = *mvlen(mvec);
+    if (!n) return 0;
+    const char* base = mvec;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = cmp(base + half * element_size, key) <= 0
+            ? base + half * element_size : base;
+        n -= half;
+    }
+    size_t index = (size_t)(base - (const char*)mvec) / element_size;
+    return index + (cmp(base, key) <= 0);
+}
+
+// Returns the index of the element of the given sorted mvec that is equal to
+// the given key, or its length if there is no such element.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not sorted by cmp
+size_t mvsorted_find(mvec_t* mvec, const void* key, cmpfunc_t cmp) {
+    size_t index = mvsorted_lowerBound(mvec, key, cmp);
+    if (index < *mvlen(mvec)
+            && cmp((char*)mvec + index * mvelsz(mvec), key) == 0)
+        return index;
+    return *mvlen(mvec);
+}
+
+// Copies the given element into its place in the given sorted mvec. If an
+// equal element is already there, it gets overwritten. Otherwise the
+// following elements are shifted with mvshift(); if the vector is full, its
+// capacity gets doubled first. On success, returns a pointer to the vector;
+// its pointer's previous value may get invalidated. On failure, returns NULL;
+// the state and the data of the given mvec remain untouched.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not sorted by cmp
+//  @ element points inside the vector
+mvec_t* mvsorted_insert(mvec_t* mvec, const void* element, cmpfunc_t cmp) {
+    size_t element_size = mvelsz(mvec);
+    size_t index = mvsorted_lowerBound(mvec, element, cmp);
+    if (index < *mvlen(mvec)
+            && cmp((char*)mvec + index * element_size, element) == 0) {
+        MVEC_MEMCPY_FUNCTION((char*)mvec + index * element_size, element,
+                element_size);
+        return mvec;
+    }
+    if (*mvlen(mvec) == mvcap(mvec)) {
+        mvec_t* new_mvec = mvresize(mvec, mvcap(mvec) ? mvcap(mvec) * 2 : 1);
+        if (!new_mvec) return NULL;
+        mvec = new_mvec;
+    }
+    if (index < *mvlen(mvec)) mvshift(mvec, index, +1);
+    else *mvlen(mvec) += 1;
+    MVEC_MEMCPY_FUNCTION((char*)mvec + index * element_size, element,
+            element_size);
+    return mvec;
+}
+
+// Removes the element equal to the given key from the given sorted mvec.
+// Returns 1 if it was found, 0 otherwise.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not sorted by cmp
+int mvsorted_erase(mvec_t* mvec, const void* key, cmpfunc_t cmp) {
+    size_t index = mvsorted_find(mvec, key, cmp);
+    if (index == *mvlen(mvec)) return 0;
+    if (index + 1 < *mvlen(mvec)) mvshift(mvec, index + 1, -1);
+    else *mvlen(mvec) -= 1;
+    return 1;
+}
+
+// Merges the given batch of quantity elements into the given sorted mvec with
+// a single backward merge pass, so inserting a batch costs
+// O(length + quantity) instead of O(length) per element. Elements of the
+// batch overwrite equal elements of the vector. If the vector is too small,
+// it gets resized to at least twice its capacity first. On success, returns a
+// pointer to the vector; its pointer's previous value may get invalidated. On
+// failure, returns NULL; the state and the data of the given mvec remain
+// untouched.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec or batch is not sorted by cmp (sort the batch with qsort() first)
+//  @ batch contains equal elements
+//  @ batch points inside the vector
+mvec_t* mvsorted_merge(
+        mvec_t* mvec,
+        const void* batch,
+        size_t quantity,
+        cmpfunc_t cmp
+        )
+{
+    size_t element_size = mvelsz(mvec);
+    size_t length = *mvlen(mvec);
+    if (length + quantity > mvcap(mvec)) {
+        size_t new_capacity = mvcap(mvec) * 2;
+        if (new_capacity < length + quantity) new_capacity = length + quantity;
+        mvec_t* new_mvec = mvresize(mvec, new_capacity);
+        if (!new_mvec) return NULL;
+        mvec = new_mvec;
+    }
+    char* data = mvec;
+    const char* src = batch;
+    size_t i = length;
+    size_t j = quantity;
+    size_t w = length + quantity;
+    // w - i >= j holds all the time, so nothing unmerged gets overwritten
+    while (j > 0) {
+        if (i > 0) {
+            int order = cmp(
+                    data + (i - 1) * element_size,
+                    src + (j - 1) * element_size
+                    );
+            if (order > 0) {
+                w--; i--;
+                MVEC_MEMMOVE_FUNCTION(
+                        data + w * element_size,
+                        data + i * element_size,
+                        element_size
+                       );
+                continue;
+            }
+            if (order == 0) i--;
+        }
+        w--; j--;
+        MVEC_MEMCPY_FUNCTION(data + w * element_size, src + j * element_size,
+                element_size);
+    }
+    // Equal elements leave a gap between the untouched prefix and the merged
+    // part
+    if (w > i)
+        MVEC_MEMMOVE_FUNCTION(
+                data + i * element_size,
+                data + w * element_size,
+                (length + quantity - w) * element_size
+               );
+    *mvlen(mvec) = i + (length + quantity - w);
+    return mvec;
+}
+
+// Allocates a new sorted mvec containing elements of both given sorted mvecs.
+// Of two equal elements, the one from b is taken. The capacity of the result
+// is the sum of the given vectors' lengths. On success, returns a pointer to
+// the new vector. On failure, returns NULL.
+// UB:
+//  @ a or b == NULL or address of not a valid mvector
+//  @ a or b is not sorted by cmp
+//  @ mvelsz(a) != mvelsz(b)
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvec_t* mvsorted_union(mvec_t* a, mvec_t* b, cmpfunc_t cmp) {
+    size_t element_size = mvelsz(a);
+    size_t a_len = *mvlen(a);
+    size_t b_len = *mvlen(b);
+    mvec_t* out = mvalloc(a_len + b_len, element_size);
+    if (!out) return NULL;
+    const char* a_data = a;
+    const char* b_data = b;
+    char* out_data = out;
+    size_t i = 0, j = 0, k = 0;
+    while (i < a_len && j < b_len) {
+        int order = cmp(a_data + i * element_size, b_data + j * element_size);
+        if (order < 0) {
+            MVEC_MEMCPY_FUNCTION(out_data + k++ * element_size,
+                    a_data + i++ * element_size, element_size);
+            continue;
+        }
+        if (order == 0) i++;
+        MVEC_MEMCPY_FUNCTION(out_data + k++ * element_size,
+                b_data + j++ * element_size, element_size);
+    }
+    MVEC_MEMCPY_FUNCTION(out_data + k * element_size, a_data + i * element_size,
+            (a_len - i) * element_size);
+    k += a_len - i;
+    MVEC_MEMCPY_FUNCTION(out_data + k * element_size, b_data + j * element_size,
+            (b_len - j) * element_size);
+    k += b_len - j;
+    *mvlen(out) = k;
+    return out;
+}
+
+// Allocates a new sorted mvec containing elements of a that have an equal
+// element in b. The capacity of the result is the smaller of the given
+// vectors' lengths. On success, returns a pointer to the new vector. On
+// failure, returns NULL.
+// UB:
+//  @ a or b == NULL or address of not a valid mvector
+//  @ a or b is not sorted by cmp
+//  @ mvelsz(a) != mvelsz(b)
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvec_t* mvsorted_intersection(mvec_t* a, mvec_t* b, cmpfunc_t cmp) {
+    size_t element_size = mvelsz(a);
+    size_t a_len = *mvlen(a);
+    size_t b_len = *mvlen(b);
+    mvec_t* out = mvalloc(a_len < b_len ? a_len : b_len, element_size);
+    if (!out) return NULL;
+    const char* a_data = a;
+    const char* b_data = b;
+    size_t i = 0, j = 0, k = 0;
+    while (i < a_len && j < b_len) {
+        int order = cmp(a_data + i * element_size, b_data + j * element_size);
+        if (order == 0)
+            MVEC_MEMCPY_FUNCTION((char*)out + k++ * element_size,
+                    a_data + i * element_size, element_size);
+        i += order <= 0;
+        j += order >= 0;
+    }
+    *mvlen(out) = k;
+    return out;
+}
+
+// Places the element of the in-order position i into the BFS position k of
+// the implicit binary tree of n nodes. Returns the next in-order position
+static size_t mvsorted_eytzingerFill(
+        const char* src,
+        char* dst,
+        size_t element_size,
+        size_t i,
+        size_t k,
+        size_t n
+        )
+{
+    if (k > n) return i;
+    i = mvsorted_eytzingerFill(src, dst, element_size, i, 2 * k, n);
+    MVEC_MEMCPY_FUNCTION(dst + (k - 1) * element_size, src + i * element_size,
+            element_size);
+    return mvsorted_eytzingerFill(src, dst, element_size, i + 1, 2 * k + 1, n);
+}
+
+// Index of the lower bound found by an Eytzinger search that stopped at k
+// (1-based BFS position past a leaf). Strips the trailing "went right" moves
+// and the last "went left" one to get back to the node where the search went
+// left for the last time
+static inline size_t mvsorted_eytzingerResult(size_t k, size_t n) {
+    while (k & 1) k >>= 1;
+    k >>= 1;
+    return k ? k - 1 : n;
+}
+
+// Allocates a new mvec with elements of the given sorted mvec rearranged in
+// the Eytzinger (breadth-first binary tree) layout. Searching such a vector
+// with mvsorted_eytzingerLowerBound() touches the first levels of the tree
+// in the same few cache lines and lets the next levels be prefetched, which
+// is faster than binary search on large vectors. The new vector's capacity
+// equals the given vector's length. On success, returns a pointer to the new
+// vector. On failure, returns NULL.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvec_t* mvsorted_toEytzinger(mvec_t* mvec) {
+    size_t n = *mvlen(mvec);
+    mvec_t* eytzinger = mvalloc(n, mvelsz(mvec));
+    if (!eytzinger) return NULL;
+    mvsorted_eytzingerFill(mvec, eytzinger, mvelsz(mvec), 0, 1, n);
+    *mvlen(eytzinger) = n;
+    return eytzinger;
+}
+
+// Returns the index of the first element (in sorted order) of the given
+// Eytzinger-layout mvec that is not less than the given key, or its length if
+// there is no such element. The index refers to the Eytzinger vector itself.
+// UB:
+//  @ eytzinger == NULL or address of not a valid mvector
+//  @ eytzinger was not made by mvsorted_toEytzinger() from a vector sorted by
+//    cmp
+size_t mvsorted_eytzingerLowerBound(
+        mvec_t* eytzinger,
+        const void* key,
+        cmpfunc_t cmp
+        )
+{
+    size_t element_size = mvelsz(eytzinger);
+    size_t n = *mvlen(eytzinger);
+    const char* data = eytzinger;
+    size_t k = 1;
+    while (k <= n)
+        k = 2 * k + (cmp(data + (k - 1) * element_size, key) < 0);
+    return mvsorted_eytzingerResult(k, n);
+}
+
+// Fast path of mvsorted_lowerBound() for int32_t vectors.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not sorted in ascending order
+size_t mvsorted_lowerBoundI32(mvdef int32_t* mvec, int32_t key) {
+    size_t n = *mvlen(mvec);
+    if (!n) return 0;
+    const int32_t* base = mvec;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = base[half] < key ? base + half : base;
+        n -= half;
+    }
+    return (size_t)(base - mvec) + (*base < key);
+}
+
+// Fast path of mvsorted_upperBound() for int32_t vectors.
+// UB:
+//  @ mvec == NULL or address of not a valid mvector
+//  @ mvec is not sorted in ascending order
+size_t mvsorted_upperBoundI32(mvdef int32_t* mvec, int32_t key) {
+    size_t n = *mvlen(mvec);
+    if (!n) return 0;
+    const int32_t* base = mvec;
+    while (n > 1) {
+        size_t half = n / 2;
+        base = base[half] <= key ? base + half : base;
+        n -= half;
+    }
+    return (size_t)(base - mvec) + (*base <= key);
+}
+
+// Fast path of mvsorted_eytzingerLowerBound() for int32_t vectors. Prefetches
+// the node four levels down while comparing the current one.
+// UB:
+//  @ eytzinger == NULL or address of not a valid mvector
+//  @ eytzinger was not made by mvsorted_toEytzinger() from a vector sorted in
+//    ascending order
+size_t mvsorted_eytzingerLowerBoundI32(mvdef int32_t* eytzinger, int32_t key) {
+    size_t n = *mvlen(eytzinger);
+    size_t k = 1;
+    while (k <= n) {
+#if defined(__GNUC__)
+        // 16 descendants four levels down share a cache line. On the last
+        // levels they are past the end, so the address is computed as an
+        // integer: prefetching it is harmless, pointer arithmetic is not
+        __builtin_prefetch((const void*)((uintptr_t)eytzinger
+                    + (16 * k - 1) * sizeof(int32_t)));
+#endif // __GNUC__
+        k = 2 * k + (eytzinger[k - 1] < key);
+    }
+    return mvsorted_eytzingerResult(k, n);
+}
+
+// Fast path of mvsorted_union() for int32_t vectors. The merge loop selects
+// the next element and advances both positions without branching on the data.
+// UB:
+//  @ a or b == NULL or address of not a valid mvector
+//  @ a or b is not sorted in ascending order or contains equal elements
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvec_t* mvsorted_unionI32(mvdef int32_t* a, mvdef int32_t* b) {
+    size_t a_len = *mvlen(a);
+    size_t b_len = *mvlen(b);
+    mvdef int32_t* out = mvalloc(a_len + b_len, sizeof(int32_t));
+    if (!out) return NULL;
+    size_t i = 0, j = 0, k = 0;
+    while (i < a_len && j < b_len) {
+        int32_t x = a[i];
+        int32_t y = b[j];
+        out[k++] = x < y ? x : y;
+        i += x <= y;
+        j += y <= x;
+    }
+    MVEC_MEMCPY_FUNCTION(out + k, a + i, (a_len - i) * sizeof(int32_t));
+    k += a_len - i;
+    MVEC_MEMCPY_FUNCTION(out + k, b + j, (b_len - j) * sizeof(int32_t));
+    k += b_len - j;
+    *mvlen(out) = k;
+    return out;
+}
+
+// Fast path of mvsorted_intersection() for int32_t vectors. With SSE2
+// available, compares blocks of four elements of a with all the rotations of
+// blocks of four elements of b at once.
+// UB:
+//  @ a or b == NULL or address of not a valid mvector
+//  @ a or b is not sorted in ascending order or contains equal elements
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvec_t* mvsorted_intersectionI32(mvdef int32_t* a, mvdef int32_t* b) {
+    size_t a_len = *mvlen(a);
+    size_t b_len = *mvlen(b);
+    mvdef int32_t* out =
+        mvalloc(a_len < b_len ? a_len : b_len, sizeof(int32_t));
+    if (!out) return NULL;
+    size_t i = 0, j = 0, k = 0;
+#ifdef MVSORTED_SSE2
+    while (i + 4 <= a_len && j + 4 <= b_len) {
+        __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+        __m128i eq = _mm_or_si128(
+                _mm_or_si128(
+                    _mm_cmpeq_epi32(va, vb),
+                    _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39))
+                    ),
+                _mm_or_si128(
+                    _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4E)),
+                    _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93))
+                    )
+                );
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+        for (size_t lane = 0; lane < 4; lane++)
+            if (mask >> lane & 1) out[k++] = a[i + lane];
+        int32_t a_max = a[i + 3];
+        int32_t b_max = b[j + 3];
+        i += a_max <= b_max ? 4 : 0;
+        j += b_max <= a_max ? 4 : 0;
+    }
+#endif // MVSORTED_SSE2
+    while (i < a_len && j < b_len) {
+        int32_t x = a[i];
+        int32_t y = b[j];
+        if (x == y) out[k++] = x;
+        i += x <= y;
+        j += y <= x;
+    }
+    *mvlen(out) = k;
+    return out;
+}
+
+#endif // MVSORTED_IMPLEMENTATION
+#endif // !MVSORTED_H
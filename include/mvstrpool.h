@@ -0,0 +1,441 @@
+// mvstrpool.h - Pool of strings and blobs in monolithic vectors
+
+/* MIT License
+
+Copyright (c) 2025 nunzayin
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE. */
+
+#ifndef MVSTRPOOL_H
+#define MVSTRPOOL_H
+
+#include <stdint.h> // uint64_t
+#include "mvec.h"
+
+// The first bytes of every serialized pool
+#define MVSTRPOOL_MAGIC "MVSTRPL1"
+
+// Returned instead of a record index when there's no such record or on failure
+#define MVSTRPOOL_NONE ((size_t)-1)
+
+// A pool keeps variable-length records one after another in a single byte
+// mvec, each followed by a '\0' so that strings can be used as they are.
+// Record i occupies bytes [offsets[i], offsets[i + 1]), including the '\0'.
+// If the pool interns its records, it also keeps the hash of each record and
+// an open-addressing table of record indices plus 1 (0 marks a free slot)
+typedef struct mvstrpool_header_t {
+    mvdef uint64_t* offsets; // mvlen() is amount of records plus 1
+    mvdef char* bytes;
+    mvdef size_t* hashes;    // NULL if the pool doesn't intern its records
+    mvdef size_t* slots;     // mvcap() is a power of two
+} MvstrpoolHeader;
+
+// Use this typedef for pools. Release them with mvstrpool_free()
+typedef MvstrpoolHeader mvstrpool_t;
+
+// The beginning of a serialized pool. It's followed by the offsets of all
+// the records and then by their bytes, all in the native byte order, so
+// the offsets and the bytes are copied as they are
+typedef struct mvstrpool_image_t {
+    char magic[8];
+    uint64_t length;
+    uint64_t bytes;
+} MvstrpoolImage;
+
+// Functions cheatsheet. Check out their implementations for detailed
+// descriptions
+
+mvstrpool_t* mvstrpool_alloc(size_t length, size_t bytes, int intern);
+void mvstrpool_free(mvstrpool_t* pool);
+size_t mvstrpool_append(mvstrpool_t* pool, const void* data, size_t size);
+size_t mvstrpool_find(mvstrpool_t* pool, const void* data, size_t size);
+int mvstrpool_sort(mvstrpool_t* pool, mvdef size_t* order);
+mvec_t* mvstrpool_serialize(mvstrpool_t* pool);
+mvstrpool_t* mvstrpool_deserialize(
+        const void* buffer,
+        size_t bytes,
+        int intern
+        );
+static inline size_t mvstrpool_len(mvstrpool_t* pool);
+static inline char* mvstrpool_get(mvstrpool_t* pool, size_t index);
+static inline size_t mvstrpool_size(mvstrpool_t* pool, size_t index);
+
+// Returns amount of records of the given pool.
+// UB: pool == NULL or address of not a valid pool
+static inline size_t mvstrpool_len(mvstrpool_t* pool) {
+    return *mvlen(pool->offsets) - 1;
+}
+
+// Returns address of the record with the given index. It's followed by '\0'.
+// The address stays valid until the next mvstrpool_append() or
+// mvstrpool_sort().
+// UB:
+//  @ pool == NULL or address of not a valid pool
+//  @ index >= mvstrpool_len(pool)
+static inline char* mvstrpool_get(mvstrpool_t* pool, size_t index) {
+    return pool->bytes + pool->offsets[index];
+}
+
+// Returns size of the record with the given index in bytes, not counting
+// the '\0' after it.
+// UB:
+//  @ pool == NULL or address of not a valid pool
+//  @ index >= mvstrpool_len(pool)
+static inline size_t mvstrpool_size(mvstrpool_t* pool, size_t index) {
+    return pool->offsets[index + 1] - pool->offsets[index] - 1;
+}
+
+#ifdef MVSTRPOOL_IMPLEMENTATION
+#undef MVSTRPOOL_IMPLEMENTATION
+
+#include <stdlib.h> // qsort
+#include <string.h> // memcpy, memcmp, memset
+
+// Mixes 8 bytes at a time and finalizes the result with MurmurHash3's fmix64
+static size_t mvstrpool_hash(const void* data, size_t size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    uint64_t h = 0xcbf29ce484222325ull ^ size;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        memcpy(&word, bytes + i, 8);
+        h = (h ^ word) * 0x9e3779b97f4a7c15ull;
+        h ^= h >> 32;
+    }
+    for (; i < size; i++)
+        h = (h ^ bytes[i]) * 0x100000001b3ull;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdull;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ull;
+    h ^= h >> 33;
+    return (size_t)h;
+}
+
+// Returns the slot holding the record equal to the given data, or the free
+// slot where it belongs
+static size_t mvstrpool_probe(
+        mvstrpool_t* pool,
+        const void* data,
+        size_t size,
+        size_t hash
+        )
+{
+    size_t mask = mvcap(pool->slots) - 1;
+    for (size_t slot = hash & mask;; slot = (slot + 1) & mask) {
+        size_t index = pool->slots[slot];
+        if (!index--) return slot;
+        if (pool->hashes[index] == hash && mvstrpool_size(pool, index) == size
+                && !memcmp(mvstrpool_get(pool, index), data, size))
+            return slot;
+    }
+}
+
+// Puts all the records of the given pool into its empty slots. Returns 1 on
+// success. If two of the records are equal, returns 0
+static int mvstrpool_index(mvstrpool_t* pool) {
+    for (size_t i = 0; i < mvstrpool_len(pool); i++) {
+        size_t slot = mvstrpool_probe(
+                pool, mvstrpool_get(pool, i), mvstrpool_size(pool, i),
+                pool->hashes[i]
+                );
+        if (pool->slots[slot]) return 0;
+        pool->slots[slot] = i + 1;
+    }
+    return 1;
+}
+
+// Replaces the slots of the given pool with the given amount of slots and
+// puts all the records into them. Returns 1 on success. On failure, returns
+// 0; the pool remains untouched
+static int mvstrpool_rehash(mvstrpool_t* pool, size_t capacity) {
+    mvdef size_t* slots = mvcalloc(capacity, sizeof(size_t));
+    if (!slots) return 0;
+    *mvlen(slots) = capacity;
+    if (pool->slots) mvfree(pool->slots);
+    pool->slots = slots;
+    mvstrpool_index(pool);
+    return 1;
+}
+
+// Makes the given mvec able to hold the given amount of elements, at least
+// doubling its capacity if it grows. On success, returns a pointer to the
+// mvec; its pointer's previous value may get invalidated. On failure, returns
+// NULL; the mvec remains untouched
+static mvec_t* mvstrpool_reserve(mvec_t* mvec, size_t capacity) {
+    if (capacity <= mvcap(mvec)) return mvec;
+    if (capacity < mvcap(mvec) * 2) capacity = mvcap(mvec) * 2;
+    return mvresize(mvec, capacity);
+}
+
+// Allocates a new empty pool able to hold the given amount of records of the
+// given total size in bytes without growing. If intern is nonzero, the pool
+// keeps only one copy of equal records: mvstrpool_append() returns the index
+// of the existing one instead.
+// On success, returns a pointer to the new pool. On failure, returns NULL.
+// [UB: current allocator is not set with mvec_setAllocator()]
+mvstrpool_t* mvstrpool_alloc(size_t length, size_t bytes, int intern) {
+    mvdef mvstrpool_t* pool = mvalloc(1, sizeof(mvstrpool_t));
+    if (!pool) return NULL;
+    *mvlen(pool) = 1;
+    // Every record takes a '\0' as well
+    bytes += length;
+    pool->offsets = mvalloc(length + 1, sizeof(uint64_t));
+    pool->bytes = mvalloc(bytes ? bytes : 1, 1);
+    pool->hashes = intern ? mvalloc(length ? length : 1, sizeof(size_t)) : NULL;
+    pool->slots = NULL;
+    if (!pool->offsets || !pool->bytes || (intern && !pool->hashes))
+        goto fail;
+    pool->offsets[(*mvlen(pool->offsets))++] = 0;
+    if (!intern) return pool;
+    size_t slots = 16;
+    while (slots < length * 2) slots *= 2;
+    if (mvstrpool_rehash(pool, slots)) return pool;
+fail:
+    if (pool->offsets) mvfree(pool->offsets);
+    if (pool->bytes) mvfree(pool->bytes);
+    if (pool->hashes) mvfree(pool->hashes);
+    mvfree(pool);
+    return NULL;
+}
+
+// Deallocates the given pool with all of its records.
+// UB: pool == NULL or address of not a valid pool
+void mvstrpool_free(mvstrpool_t* pool) {
+    mvfree(pool->offsets);
+    mvfree(pool->bytes);
+    if (pool->hashes) {
+        mvfree(pool->hashes);
+        mvfree(pool->slots);
+    }
+    mvfree(pool);
+}
+
+// Appends a copy of size bytes at the given address followed by '\0' to the
+// given pool. Grows the pool's mvecs at least twice when they are full. If
+// the pool interns its records and an equal record is already there, doesn't
+// append anything. Returns the index of the record. On failure, returns
+// MVSTRPOOL_NONE; the records of the pool remain untouched.
+// UB:
+//  @ pool == NULL or address of not a valid pool
+//  @ data is not a valid pointer to size bytes
+//  @ data points inside the pool
+size_t mvstrpool_append(mvstrpool_t* pool, const void* data, size_t size) {
+    size_t length = mvstrpool_len(pool);
+    size_t hash = 0, slot = 0;
+    if (pool->hashes) {
+        hash = mvstrpool_hash(data, size);
+        slot = mvstrpool_probe(pool, data, size, hash);
+        if (pool->slots[slot]) return pool->slots[slot] - 1;
+    }
+    size_t end = pool->offsets[length];
+    char* bytes = mvstrpool_reserve(pool->bytes, end + size + 1);
+    if (!bytes) return MVSTRPOOL_NONE;
+    pool->bytes = bytes;
+    uint64_t* offsets = mvstrpool_reserve(pool->offsets, length + 2);
+    if (!offsets) return MVSTRPOOL_NONE;
+    pool->offsets = offsets;
+    if (pool->hashes) {
+        size_t* hashes = mvstrpool_reserve(pool->hashes, length + 1);
+        if (!hashes) return MVSTRPOOL_NONE;
+        pool->hashes = hashes;
+        // Keeps at least half of the slots free
+        if ((length + 1) * 2 > mvcap(pool->slots)) {
+            if (!mvstrpool_rehash(pool, mvcap(pool->slots) * 2))
+                return MVSTRPOOL_NONE;
+            slot = mvstrpool_probe(pool, data, size, hash);
+        }
+        pool->hashes[(*mvlen(pool->hashes))++] = hash;
+        pool->slots[slot] = length + 1;
+    }
+    MVEC_MEMCPY_FUNCTION(pool->bytes + end, data, size);
+    pool->bytes[end + size] = '\0';
+    *mvlen(pool->bytes) = end + size + 1;
+    pool->offsets[(*mvlen(pool->offsets))++] = end + size + 1;
+    return length;
+}
+
+// Returns the index of the record equal to size bytes at the given address.
+// If there's no such record, returns MVSTRPOOL_NONE. Takes O(1) on average if
+// the pool interns its records and O(mvstrpool_len(pool)) otherwise.
+// UB:
+//  @ pool == NULL or address of not a valid pool
+//  @ data is not a valid pointer to size bytes
+size_t mvstrpool_find(mvstrpool_t* pool, const void* data, size_t size) {
+    if (pool->hashes) {
+        size_t hash = mvstrpool_hash(data, size);
+        size_t index = pool->slots[mvstrpool_probe(pool, data, size, hash)];
+        return index ? index - 1 : MVSTRPOOL_NONE;
+    }
+    for (size_t i = 0; i < mvstrpool_len(pool); i++) {
+        if (mvstrpool_size(pool, i) == size
+                && !memcmp(mvstrpool_get(pool, i), data, size))
+            return i;
+    }
+    return MVSTRPOOL_NONE;
+}
+
+// A record to sort. The first 8 bytes of the record, big-endian, decide most
+// of the comparisons without touching the record itself
+typedef struct mvstrpool_entry_t {
+    uint64_t prefix;
+    const unsigned char* data;
+    size_t size;
+    size_t index;
+} MvstrpoolEntry;
+
+static int mvstrpool_compareEntries(const void* a, const void* b) {
+    const MvstrpoolEntry* x = (const MvstrpoolEntry*)a;
+    const MvstrpoolEntry* y = (const MvstrpoolEntry*)b;
+    if (x->prefix != y->prefix) return x->prefix < y->prefix ? -1 : 1;
+    int cmp = memcmp(x->data, y->data, x->size < y->size ? x->size : y->size);
+    if (cmp) return cmp;
+    if (x->size != y->size) return x->size < y->size ? -1 : 1;
+    return x->index < y->index ? -1 : x->index > y->index;
+}
+
+// Sorts the records of the given pool in the memcmp() order, a shorter record
+// going before the longer one it starts with. Equal records keep their order.
+// Rebuilds the bytes of the pool in the new order, so that neighbouring records
+// stay neighbours in memory. If order isn't NULL, sets its length to
+// mvstrpool_len(pool) and puts the old index of every record at its new index.
+// Returns 1 on success. On failure, returns 0; the pool remains untouched.
+// UB:
+//  @ pool == NULL or address of not a valid pool
+//  @ order != NULL and mvcap(order) < mvstrpool_len(pool)
+int mvstrpool_sort(mvstrpool_t* pool, mvdef size_t* order) {
+    size_t length = mvstrpool_len(pool);
+    mvdef MvstrpoolEntry* entries = mvalloc(length + 1, sizeof(MvstrpoolEntry));
+    mvdef char* bytes = mvalloc(mvcap(pool->bytes), 1);
+    if (!entries || !bytes) {
+        if (entries) mvfree(entries);
+        if (bytes) mvfree(bytes);
+        return 0;
+    }
+    for (size_t i = 0; i < length; i++) {
+        MvstrpoolEntry* entry = entries + i;
+        entry->data = (const unsigned char*)mvstrpool_get(pool, i);
+        entry->size = mvstrpool_size(pool, i);
+        entry->index = i;
+        entry->prefix = 0;
+        for (size_t j = 0; j < 8; j++) {
+            entry->prefix <<= 8;
+            if (j < entry->size) entry->prefix |= entry->data[j];
+        }
+    }
+    qsort(entries, length, sizeof(MvstrpoolEntry), mvstrpool_compareEntries);
+    size_t end = 0;
+    for (size_t i = 0; i < length; i++) {
+        size_t bytes_size = entries[i].size + 1;
+        MVEC_MEMCPY_FUNCTION(bytes + end, entries[i].data, bytes_size);
+        end += bytes_size;
+        pool->offsets[i + 1] = end;
+        // Hashes are permuted in place of the no longer needed prefixes
+        if (pool->hashes) entries[i].prefix = pool->hashes[entries[i].index];
+        if (order) order[i] = entries[i].index;
+    }
+    *mvlen(bytes) = end;
+    mvfree(pool->bytes);
+    pool->bytes = bytes;
+    if (order) *mvlen(order) = length;
+    if (pool->hashes) {
+        for (size_t i = 0; i < length; i++)
+            pool->hashes[i] = (size_t)entries[i].prefix;
+        memset(pool->slots, 0, mvcap(pool->slots) * sizeof(size_t));
+        mvstrpool_index(pool);
+    }
+    mvfree(entries);
+    return 1;
+}
+
+// Allocates a byte mvec holding the given pool as a single buffer: an
+// MvstrpoolImage followed by the offsets and the bytes of the records. Its
+// length is the size of the buffer. Interning is not stored.
+// On success, returns the byte mvec. On failure, returns NULL.
+// UB: pool == NULL or address of not a valid pool
+mvec_t* mvstrpool_serialize(mvstrpool_t* pool) {
+    size_t offsets_size = *mvlen(pool->offsets) * sizeof(uint64_t);
+    size_t bytes = sizeof(MvstrpoolImage) + offsets_size + *mvlen(pool->bytes);
+    mvdef char* buffer = mvalloc(bytes, 1);
+    if (!buffer) return NULL;
+    *mvlen(buffer) = bytes;
+    MvstrpoolImage image;
+    memcpy(image.magic, MVSTRPOOL_MAGIC, 8);
+    image.length = mvstrpool_len(pool);
+    image.bytes = *mvlen(pool->bytes);
+    MVEC_MEMCPY_FUNCTION(buffer, &image, sizeof(image));
+    MVEC_MEMCPY_FUNCTION(buffer + sizeof(image), pool->offsets, offsets_size);
+    MVEC_MEMCPY_FUNCTION(buffer + sizeof(image) + offsets_size, pool->bytes,
+            image.bytes);
+    return buffer;
+}
+
+// Allocates a new pool holding the records of the buffer of the given size
+// in bytes made by mvstrpool_serialize(). The offsets and the bytes are copied
+// as they are; the offsets are only checked to be valid. If intern is
+// nonzero, the pool interns its records.
+// On success, returns a pointer to the new pool. On failure (including the
+// cases when the buffer doesn't hold a valid pool or intern is nonzero and
+// the buffer holds equal records), returns NULL.
+// UB:
+//  @ buffer is not a valid pointer to the given amount of bytes
+//  [@ current allocator is not set with mvec_setAllocator()]
+mvstrpool_t* mvstrpool_deserialize(
+        const void* buffer,
+        size_t bytes,
+        int intern
+        )
+{
+    MvstrpoolImage image;
+    if (bytes < sizeof(image)) return NULL;
+    MVEC_MEMCPY_FUNCTION(&image, buffer, sizeof(image));
+    if (memcmp(image.magic, MVSTRPOOL_MAGIC, 8)) return NULL;
+    size_t left = (bytes - sizeof(image)) / sizeof(uint64_t);
+    if (image.length >= left || image.bytes > bytes) return NULL;
+    size_t offsets_size = (image.length + 1) * sizeof(uint64_t);
+    if (sizeof(image) + offsets_size + image.bytes != bytes) return NULL;
+    mvstrpool_t* pool = mvstrpool_alloc(image.length, image.bytes, intern);
+    if (!pool) return NULL;
+    const char* data = (const char*)buffer + sizeof(image);
+    MVEC_MEMCPY_FUNCTION(pool->offsets, data, offsets_size);
+    *mvlen(pool->offsets) = image.length + 1;
+    MVEC_MEMCPY_FUNCTION(pool->bytes, data + offsets_size, image.bytes);
+    *mvlen(pool->bytes) = image.bytes;
+    const uint64_t* offsets = pool->offsets;
+    int valid = !offsets[0] && offsets[image.length] == image.bytes;
+    for (size_t i = 0; valid && i < image.length; i++) {
+        valid = offsets[i + 1] > offsets[i]
+            && !pool->bytes[offsets[i + 1] - 1];
+    }
+    if (valid && intern) {
+        for (size_t i = 0; i < image.length; i++) {
+            pool->hashes[i] = mvstrpool_hash(
+                    mvstrpool_get(pool, i), mvstrpool_size(pool, i)
+                    );
+        }
+        *mvlen(pool->hashes) = image.length;
+        valid = mvstrpool_index(pool);
+    }
+    if (valid) return pool;
+    mvstrpool_free(pool);
+    return NULL;
+}
+
+#endif // MVSTRPOOL_IMPLEMENTATION
+#endif // !MVSTRPOOL_H
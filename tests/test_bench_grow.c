@@ -0,0 +1,106 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#define MVEC_CUSTOM_ALLOCATORS
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVGROW_IMPLEMENTATION
+#include "mvgrow.h"
+
+static const size_t AMOUNT_VALUES = 1 << 26;
+static const size_t STEP_BYTES = 4096;
+static const size_t REPEATS = 3;
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// An allocator whose realloc always copies, unlike the libc one which may
+// remap large blocks. Keeps the block size in front of the block
+static void* copyAlloc(size_t bytes) {
+    size_t* block = malloc(bytes + 16);
+    if (!block) return NULL;
+    *block = bytes;
+    return (char*)block + 16;
+}
+
+static void copyFree(void* ptr) {
+    if (ptr) free((char*)ptr - 16);
+}
+
+static void* copyRealloc(void* ptr, size_t bytes) {
+    if (!ptr) return copyAlloc(bytes);
+    void* moved = copyAlloc(bytes);
+    if (!moved) return NULL;
+    size_t old_bytes = *(size_t*)((char*)ptr - 16);
+    memcpy(moved, ptr, old_bytes < bytes ? old_bytes : bytes);
+    copyFree(ptr);
+    return moved;
+}
+
+// Total and worst single push times of an mvec growing via mvresize()
+static void measureResize(double* total, double* worst) {
+    mvdef uint64_t* values = mvalloc(1, sizeof(uint64_t));
+    assert(values);
+    *worst = 0;
+    double start = now();
+    for (uint64_t i = 0; i < AMOUNT_VALUES; i++) {
+        double before = now();
+        if (*mvlen(values) == mvcap(values)) {
+            values = mvresize(values, mvcap(values) * 2);
+            assert(values);
+        }
+        values[(*mvlen(values))++] = i;
+        double took = now() - before;
+        if (took > *worst) *worst = took;
+    }
+    *total = now() - start;
+    mvfree(values);
+}
+
+// The same for an incrementally growing vector, finishing the migrations
+// outside of the pushes
+static void measureGrow(double* total, double* worst) {
+    mvgrow_t* grow = mvgrow_alloc(1, sizeof(uint64_t), STEP_BYTES);
+    assert(grow);
+    *worst = 0;
+    double start = now();
+    for (uint64_t i = 0; i < AMOUNT_VALUES; i++) {
+        double before = now();
+        assert(mvgrow_push(grow, &i));
+        double took = now() - before;
+        if (took > *worst) *worst = took;
+        // Idle time between the pushes
+        if (grow->old && !mvgrow_migrating(grow)) mvgrow_finish(grow);
+    }
+    *total = now() - start;
+    mvgrow_free(grow);
+}
+
+// The worst push is the least of the repeats, so that random preemptions
+// don't count as stalls
+static void report(const char* name, void (*measure)(double*, double*)) {
+    double total = 0, worst = 1e9;
+    for (size_t r = 0; r < REPEATS; r++) {
+        double run_total, run_worst;
+        measure(&run_total, &run_worst);
+        total += run_total / REPEATS;
+        if (run_worst < worst) worst = run_worst;
+    }
+    printf("%-18s: %.3f s total, %.3f ms worst push\n",
+            name, total, worst * 1e3);
+}
+
+int main(void) {
+    mvec_setAllocator(malloc, realloc, free);
+    report("mvresize, libc", measureResize);
+    report("mvgrow, libc", measureGrow);
+    mvec_setAllocator(copyAlloc, copyRealloc, copyFree);
+    report("mvresize, copying", measureResize);
+    report("mvgrow, copying", measureGrow);
+}
@@ -0,0 +1,83 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#define MVEC_IMPLEMENTATION
+#define MVHASH_IMPLEMENTATION
+#include "mvhash.h"
+
+static const size_t AMOUNT_KEYS = 10000000;
+
+// xorshift64, so the keys do not depend on RAND_MAX
+static uint64_t rng_state = 88172645463325252ull;
+static inline uint64_t randu64(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static double seconds_since(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void report(const char* what, size_t operations, double seconds) {
+    fprintf(stderr, "%-24s %6.2fs %8.2f Mops/s\n",
+            what, seconds, operations / seconds / 1e6);
+}
+
+int main(void) {
+    mvdef uint64_t* keys = mvalloc(AMOUNT_KEYS, sizeof(uint64_t));
+    assert(keys);
+    for (size_t i = 0; i < AMOUNT_KEYS; i++)
+        keys[(*mvlen(keys))++] = randu64();
+
+    fprintf(stderr,
+            "Benchmarking mvhash with %zu uint64_t -> uint64_t entries\n",
+            AMOUNT_KEYS
+            );
+
+    mvhash_t* map = mvhash_alloc(0, sizeof(uint64_t), sizeof(uint64_t),
+            NULL, NULL);
+    assert(map);
+    clock_t start = clock();
+    for (size_t i = 0; i < AMOUNT_KEYS; i++)
+        assert((map = mvhash_put(map, &keys[i], &i)));
+    report("insert (growing)", AMOUNT_KEYS, seconds_since(start));
+    mvfree(map);
+
+    map = mvhash_alloc(AMOUNT_KEYS, sizeof(uint64_t), sizeof(uint64_t),
+            NULL, NULL);
+    assert(map);
+    start = clock();
+    for (size_t i = 0; i < AMOUNT_KEYS; i++)
+        assert((map = mvhash_put(map, &keys[i], &i)));
+    report("insert (reserved)", AMOUNT_KEYS, seconds_since(start));
+
+    size_t found = 0;
+    start = clock();
+    for (size_t i = 0; i < AMOUNT_KEYS; i++)
+        found += mvhash_get(map, &keys[AMOUNT_KEYS - 1 - i]) != NULL;
+    report("lookup (hit)", AMOUNT_KEYS, seconds_since(start));
+    assert(found == mvhash_len(map));
+
+    found = 0;
+    start = clock();
+    for (size_t i = 0; i < AMOUNT_KEYS; i++) {
+        uint64_t key = randu64();
+        found += mvhash_get(map, &key) != NULL;
+    }
+    report("lookup (miss)", AMOUNT_KEYS, seconds_since(start));
+
+    start = clock();
+    for (size_t i = 0; i < AMOUNT_KEYS; i += 2)
+        mvhash_remove(map, &keys[i]);
+    report("remove", AMOUNT_KEYS / 2, seconds_since(start));
+
+    fprintf(stderr, "Slots: %zu, whole size: %zu bytes\n",
+            mvhash_cap(map), mvsize(map));
+
+    mvfree(map);
+    mvfree(keys);
+}
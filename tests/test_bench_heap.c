@@ -0,0 +1,142 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVHEAP_IMPLEMENTATION
+#include "mvheap.h"
+
+static const size_t AMOUNT_VALUES = 1 << 21;
+static const size_t AMOUNT_REPLACES = 1 << 21;
+
+typedef struct {
+    uint64_t priority;
+    uint64_t id;
+} Task;
+
+static int taskComp(const void* _a, const void* _b) {
+    const Task* a = _a;
+    const Task* b = _b;
+    return (a->priority > b->priority) - (a->priority < b->priority);
+}
+
+static uint64_t next(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// A binary heap the usual way: comparator calls and memcpy() swaps
+static void swap(char* a, char* b, size_t size) {
+    char tmp[64];
+    memcpy(tmp, a, size);
+    memcpy(a, b, size);
+    memcpy(b, tmp, size);
+}
+
+static void binaryUp(char* heap, size_t size, size_t i, cmpfunc_t cmp) {
+    while (i && cmp(heap + i * size, heap + (i - 1) / 2 * size) < 0) {
+        swap(heap + i * size, heap + (i - 1) / 2 * size, size);
+        i = (i - 1) / 2;
+    }
+}
+
+static void binaryDown(char* heap, size_t size, size_t n, cmpfunc_t cmp) {
+    for (size_t i = 0;;) {
+        size_t least = i, l = 2 * i + 1, r = l + 1;
+        if (l < n && cmp(heap + l * size, heap + least * size) < 0) least = l;
+        if (r < n && cmp(heap + r * size, heap + least * size) < 0) least = r;
+        if (least == i) return;
+        swap(heap + i * size, heap + least * size, size);
+        i = least;
+    }
+}
+
+// Nanoseconds per push, replace-top and pop of a scheduler-like workload.
+// Replaced tasks get rescheduled either a bit later, so they only sink a few
+// levels, or anywhere, so they mostly sink to the bottom like popped ones
+static void measure(int kind, int shift, double* ns) {
+    uint64_t state = 88172645463325252ull;
+    mvdef Task* tasks = mvalloc(AMOUNT_VALUES, sizeof(Task));
+    mvdef uint64_t* keys = mvalloc(AMOUNT_VALUES, sizeof(uint64_t));
+    assert(tasks && keys);
+    uint64_t checksum = 0;
+
+    double start = now();
+    for (uint64_t i = 0; i < AMOUNT_VALUES; i++) {
+        Task task = {next(&state) >> 20, i};
+        if (kind == 0) {
+            tasks[(*mvlen(tasks))++] = task;
+            binaryUp((char*)tasks, sizeof(Task), i, taskComp);
+        } else if (kind == 1) {
+            assert(mvheap_push(tasks, &task, taskComp) == tasks);
+        } else {
+            assert(mvheap_pushU64(keys, task.priority << 20 | i) == keys);
+        }
+    }
+    ns[0] = (now() - start) / AMOUNT_VALUES * 1e9;
+
+    // The popped task gets rescheduled later
+    start = now();
+    for (uint64_t i = 0; i < AMOUNT_REPLACES; i++) {
+        uint64_t delay = next(&state) >> shift;
+        if (kind == 0) {
+            checksum += tasks[0].id;
+            tasks[0].priority += delay;
+            binaryDown((char*)tasks, sizeof(Task), *mvlen(tasks), taskComp);
+        } else if (kind == 1) {
+            Task task = tasks[0];
+            checksum += task.id;
+            task.priority += delay;
+            mvheap_replaceTop(tasks, &task, NULL, taskComp);
+        } else {
+            uint64_t key = keys[0];
+            checksum += key & 0xfffff;
+            mvheap_replaceTopU64(keys, key + (delay << 20));
+        }
+    }
+    ns[1] = (now() - start) / AMOUNT_REPLACES * 1e9;
+
+    start = now();
+    for (size_t i = 0; i < AMOUNT_VALUES; i++) {
+        if (kind == 0) {
+            checksum += tasks[0].id;
+            tasks[0] = tasks[--*mvlen(tasks)];
+            binaryDown((char*)tasks, sizeof(Task), *mvlen(tasks), taskComp);
+        } else if (kind == 1) {
+            Task task;
+            assert(mvheap_pop(tasks, &task, taskComp));
+            checksum += task.id;
+        } else {
+            uint64_t key;
+            assert(mvheap_popU64(keys, &key));
+            checksum += key & 0xfffff;
+        }
+    }
+    ns[2] = (now() - start) / AMOUNT_VALUES * 1e9;
+    fprintf(stderr, "checksum %llu\n", (unsigned long long)checksum);
+    mvfree(tasks);
+    mvfree(keys);
+}
+
+int main(void) {
+    const char* names[] = {"binary heap", "mvheap", "mvheap U64"};
+    printf("%zu elements, arity %d, ns per push / replace-top (near, far) "
+            "/ pop\n", AMOUNT_VALUES, MVHEAP_ARITY);
+    for (int kind = 0; kind < 3; kind++) {
+        double near[3], far[3];
+        measure(kind, 44, near);
+        measure(kind, 20, far);
+        printf("%-12s: %6.1f %6.1f %6.1f %6.1f\n",
+                names[kind], near[0], near[1], far[1], far[2]);
+    }
+}
@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVPACK_IMPLEMENTATION
+#include "mvpack.h"
+
+static const size_t AMOUNT_VALUES = 1 << 25;
+static const size_t REPEATS = 10;
+
+// xorshift64, so the values do not depend on RAND_MAX
+static uint64_t rng_state = 88172645463325252ull;
+static inline uint64_t randu64(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+static double seconds_since(clock_t start) {
+    return (double)(clock() - start) / CLOCKS_PER_SEC;
+}
+
+static void report(const char* what, size_t bytes, double seconds) {
+    fprintf(stderr, "%-32s %6.2fs %8.2f GB/s\n",
+            what, seconds, bytes / seconds / 1e9);
+}
+
+static void bench(const char* name, mvec_t* mvec) {
+    size_t bytes = *mvlen(mvec) * mvelsz(mvec);
+    clock_t start = clock();
+    mvpack_t* pack = mvec_compress(mvec);
+    assert(pack);
+    double compress_time = seconds_since(start);
+    fprintf(stderr, "%s: %zu -> %zu bytes (%.2fx)\n",
+            name, bytes, *mvlen(pack), (double)bytes / *mvlen(pack));
+    report("  compress", bytes, compress_time);
+
+    start = clock();
+    for (size_t r = 0; r < REPEATS; r++) {
+        mvec_t* copy = mvec_decompress(pack);
+        assert(copy);
+        mvfree(copy);
+    }
+    report("  decompress", bytes * REPEATS, seconds_since(start));
+
+    // Scanning in pieces that fit in the cache
+    mvec_t* piece = mvalloc(64 * MVPACK_BLOCK, mvelsz(mvec));
+    assert(piece);
+    uint64_t checksum = 0;
+    start = clock();
+    for (size_t r = 0; r < REPEATS; r++) {
+        for (size_t b = 0; b < mvpack_blocks(pack); b += 64) {
+            *mvlen(piece) = 0;
+            size_t count = mvpack_blocks(pack) - b < 64
+                ? mvpack_blocks(pack) - b : 64;
+            piece = mvpack_decode(pack, b, count, piece);
+            assert(piece);
+            checksum += ((unsigned char*)piece)[0];
+        }
+    }
+    report("  streaming decode", bytes * REPEATS, seconds_since(start));
+
+    start = clock();
+    for (size_t r = 0; r < REPEATS; r++) {
+        mvec_t* copy = mvcopy(mvec, mvcap(mvec));
+        assert(copy);
+        checksum += ((unsigned char*)copy)[r];
+        mvfree(copy);
+    }
+    report("  mvcopy for comparison", bytes * REPEATS, seconds_since(start));
+    fprintf(stderr, "  (checksum %llu)\n", (unsigned long long)checksum);
+    mvfree(piece);
+    mvfree(pack);
+}
+
+int main(void) {
+    mvdef uint32_t* ids = mvalloc(AMOUNT_VALUES, sizeof(uint32_t));
+    assert(ids);
+    uint32_t id = 0;
+    for (size_t i = 0; i < AMOUNT_VALUES; i++)
+        ids[(*mvlen(ids))++] = id += 1 + randu64() % 8;
+    bench("sorted uint32_t ids", ids);
+    mvfree(ids);
+
+    mvdef uint64_t* timestamps = mvalloc(AMOUNT_VALUES, sizeof(uint64_t));
+    assert(timestamps);
+    uint64_t timestamp = 1700000000000000000ull;
+    for (size_t i = 0; i < AMOUNT_VALUES; i++)
+        timestamps[(*mvlen(timestamps))++] = timestamp += randu64() % 100000;
+    bench("uint64_t timestamps (ns)", timestamps);
+    mvfree(timestamps);
+}
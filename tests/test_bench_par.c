@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <unistd.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVPAR_IMPLEMENTATION
+#include "mvpar.h"
+
+static const size_t AMOUNT_VALUES = 1 << 26;
+static const size_t REPEATS = 5;
+
+// Wall time: clock() would sum up the time of all the threads
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void scale(void* first, size_t count, size_t index, void* arg) {
+    uint32_t* values = first;
+    (void)index;
+    (void)arg;
+    for (size_t i = 0; i < count; i++)
+        values[i] = values[i] * 3 + 1;
+}
+
+static void square(void* dest, const void* src, size_t count, void* arg) {
+    uint64_t* to = dest;
+    const uint32_t* from = src;
+    (void)arg;
+    for (size_t i = 0; i < count; i++)
+        to[i] = (uint64_t)from[i] * from[i];
+}
+
+static void add(void* acc, const void* element, void* arg) {
+    (void)arg;
+    *(uint32_t*)acc += *(const uint32_t*)element;
+}
+
+// Seconds per run of each of for-each, map, reduce and scan
+static void measure(size_t threads, double* seconds) {
+    MvparPool* pool = mvpar_create(threads);
+    assert(pool);
+    mvdef uint32_t* values = mvalloc(AMOUNT_VALUES, sizeof(uint32_t));
+    mvdef uint64_t* squares = mvalloc(AMOUNT_VALUES, sizeof(uint64_t));
+    mvdef uint32_t* prefixes = mvalloc(AMOUNT_VALUES, sizeof(uint32_t));
+    assert(values && squares && prefixes);
+    for (size_t i = 0; i < AMOUNT_VALUES; i++)
+        values[(*mvlen(values))++] = (uint32_t)i;
+    uint32_t zero = 0, sum = 0;
+
+    double start = now();
+    for (size_t r = 0; r < REPEATS; r++)
+        mvpar_forEach(pool, values, scale, NULL);
+    seconds[0] = (now() - start) / REPEATS;
+    start = now();
+    for (size_t r = 0; r < REPEATS; r++)
+        assert(mvpar_map(pool, squares, values, square, NULL) == squares);
+    seconds[1] = (now() - start) / REPEATS;
+    start = now();
+    for (size_t r = 0; r < REPEATS; r++)
+        assert(mvpar_reduce(pool, values, &sum, &zero, add, NULL));
+    seconds[2] = (now() - start) / REPEATS;
+    start = now();
+    for (size_t r = 0; r < REPEATS; r++)
+        assert(mvpar_scan(pool, prefixes, values, &zero, add, NULL, 0));
+    seconds[3] = (now() - start) / REPEATS;
+    assert(prefixes[AMOUNT_VALUES - 1] == sum);
+
+    mvfree(prefixes);
+    mvfree(squares);
+    mvfree(values);
+    mvpar_destroy(pool);
+}
+
+int main(void) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t max_threads = online > 0 ? (size_t)online : 1;
+    double base[4];
+    fprintf(stderr,
+            "Benchmarking mvpar with %zu uint32_t values, up to %zu threads\n"
+            "%8s %16s %16s %16s %16s\n",
+            AMOUNT_VALUES, max_threads,
+            "threads", "for-each", "map", "reduce", "scan"
+            );
+    // Powers of two and the amount of processors
+    for (size_t threads = 1;; threads *= 2) {
+        if (threads > max_threads) threads = max_threads;
+        double seconds[4];
+        measure(threads, seconds);
+        if (threads == 1)
+            for (int i = 0; i < 4; i++) base[i] = seconds[i];
+        fprintf(stderr, "%8zu", threads);
+        for (int i = 0; i < 4; i++)
+            fprintf(stderr, " %8.1fms %5.2fx", seconds[i] * 1e3,
+                    base[i] / seconds[i]);
+        fputc('\n', stderr);
+        if (threads == max_threads) break;
+    }
+}
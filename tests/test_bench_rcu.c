@@ -0,0 +1,111 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVRCU_IMPLEMENTATION
+#include "mvrcu.h"
+
+#define MAX_READERS 64
+static const size_t TABLE_LENGTH = 1024;
+static const double SECONDS = 1.0;
+
+static mvrcu_t* rcu;
+static pthread_rwlock_t lock = PTHREAD_RWLOCK_INITIALIZER;
+static mvdef uint32_t* locked_table;
+static int done;
+static size_t checksum; // Keeps the reads from being optimized away
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static mvec_t* table(uint32_t seed) {
+    mvdef uint32_t* values = mvalloc(TABLE_LENGTH, sizeof(uint32_t));
+    assert(values);
+    for (size_t i = 0; i < TABLE_LENGTH; i++)
+        values[(*mvlen(values))++] = seed + (uint32_t)i;
+    return values;
+}
+
+// A lookup is a single element read, so the cost of the read section shows
+static void* rwlockReader(void* arg) {
+    size_t reads = 0, sum = 0;
+    while (!__atomic_load_n(&done, __ATOMIC_RELAXED)) {
+        pthread_rwlock_rdlock(&lock);
+        sum += locked_table[reads % TABLE_LENGTH];
+        pthread_rwlock_unlock(&lock);
+        reads++;
+    }
+    __atomic_fetch_add(&checksum, sum, __ATOMIC_RELAXED);
+    *(size_t*)arg = reads;
+    return NULL;
+}
+
+static void* rcuReader(void* arg) {
+    size_t slot = mvrcu_register(rcu);
+    assert(slot != MVRCU_NONE);
+    size_t reads = 0, sum = 0;
+    while (!__atomic_load_n(&done, __ATOMIC_RELAXED)) {
+        mvdef uint32_t* values = mvrcu_enter(rcu, slot);
+        sum += values[reads % TABLE_LENGTH];
+        mvrcu_leave(rcu, slot);
+        reads++;
+    }
+    mvrcu_unregister(rcu, slot);
+    __atomic_fetch_add(&checksum, sum, __ATOMIC_RELAXED);
+    *(size_t*)arg = reads;
+    return NULL;
+}
+
+// Millions of reads per second while the table is replaced every millisecond
+static double measure(size_t readers, int use_rcu) {
+    pthread_t threads[MAX_READERS];
+    size_t reads[MAX_READERS];
+    done = 0;
+    for (size_t i = 0; i < readers; i++) {
+        assert(!pthread_create(threads + i, NULL,
+                    use_rcu ? rcuReader : rwlockReader, reads + i));
+    }
+    double start = now();
+    for (uint32_t seed = 1; now() - start < SECONDS; seed++) {
+        mvec_t* values = table(seed);
+        if (use_rcu) {
+            assert(mvrcu_publish(rcu, values));
+        } else {
+            pthread_rwlock_wrlock(&lock);
+            mvec_t* old = locked_table;
+            locked_table = values;
+            pthread_rwlock_unlock(&lock);
+            mvfree(old);
+        }
+        usleep(1000);
+    }
+    __atomic_store_n(&done, 1, __ATOMIC_RELAXED);
+    size_t total = 0;
+    for (size_t i = 0; i < readers; i++) {
+        assert(!pthread_join(threads[i], NULL));
+        total += reads[i];
+    }
+    return total / (now() - start) / 1e6;
+}
+
+int main(void) {
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    size_t readers = online > 1 ? (size_t)online : 2;
+    if (readers > MAX_READERS) readers = MAX_READERS;
+    rcu = mvrcu_create(table(0), readers);
+    locked_table = table(0);
+    assert(rcu && locked_table);
+    printf("%zu readers\n", readers);
+    printf("rwlock: %.1f M reads/s\n", measure(readers, 0));
+    printf("mvrcu:  %.1f M reads/s\n", measure(readers, 1));
+    mvrcu_destroy(rcu);
+    mvfree(locked_table);
+}
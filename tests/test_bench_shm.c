@@ -0,0 +1,126 @@
+#include <assert.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVSHM_IMPLEMENTATION
+#include "mvshm.h"
+
+static const size_t AMOUNT_VALUES = 1 << 25;
+static const size_t BATCH = 1 << 14;
+static const size_t READERS = 3;
+
+static double now(void) {
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint64_t expectedSum(void) {
+    return (uint64_t)AMOUNT_VALUES * (AMOUNT_VALUES - 1) / 2;
+}
+
+// Transfers exactly the given amount of bytes unless the pipe is closed
+static size_t transfer(int fd, void* buffer, size_t bytes, int writing) {
+    size_t done = 0;
+    while (done < bytes) {
+        ssize_t now_done = writing
+            ? write(fd, (char*)buffer + done, bytes - done)
+            : read(fd, (char*)buffer + done, bytes - done);
+        if (now_done <= 0) break;
+        done += now_done;
+    }
+    return done;
+}
+
+static void waitReaders(pid_t* pids) {
+    for (size_t r = 0; r < READERS; r++) {
+        int status;
+        assert(waitpid(pids[r], &status, 0) == pids[r]);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    }
+}
+
+// Seconds to build the values in one process and pass them to the readers
+// through pipes, where every reader keeps its own copy of the vector
+static double measurePipe(void) {
+    int fds[READERS][2];
+    pid_t pids[READERS];
+    double start = now();
+    for (size_t r = 0; r < READERS; r++) {
+        assert(!pipe(fds[r]));
+        pids[r] = fork();
+        assert(pids[r] >= 0);
+        if (pids[r]) {
+            close(fds[r][0]);
+            continue;
+        }
+        close(fds[r][1]);
+        mvdef uint64_t* values = mvalloc(AMOUNT_VALUES, sizeof(uint64_t));
+        assert(values);
+        size_t bytes = AMOUNT_VALUES * sizeof(uint64_t);
+        uint64_t sum = 0;
+        if (transfer(fds[r][0], values, bytes, 0) == bytes)
+            for (size_t i = 0; i < AMOUNT_VALUES; i++) sum += values[i];
+        _exit(sum != expectedSum());
+    }
+    mvdef uint64_t* values = mvalloc(AMOUNT_VALUES, sizeof(uint64_t));
+    assert(values);
+    for (uint64_t i = 0; i < AMOUNT_VALUES; i += BATCH) {
+        for (size_t j = 0; j < BATCH; j++) values[i + j] = i + j;
+        for (size_t r = 0; r < READERS; r++) {
+            size_t bytes = BATCH * sizeof(uint64_t);
+            assert(transfer(fds[r][1], values + i, bytes, 1) == bytes);
+        }
+    }
+    for (size_t r = 0; r < READERS; r++) close(fds[r][1]);
+    waitReaders(pids);
+    mvfree(values);
+    return now() - start;
+}
+
+// The same through an anonymous shared vector growing along the way, which
+// the readers follow
+static double measureShm(void) {
+    mvshm_t* shm = mvec_shmCreate(NULL, BATCH, sizeof(uint64_t));
+    assert(shm);
+    pid_t pids[READERS];
+    double start = now();
+    for (size_t r = 0; r < READERS; r++) {
+        pids[r] = fork();
+        assert(pids[r] >= 0);
+        if (pids[r]) continue;
+        uint64_t sum = 0;
+        size_t done = 0;
+        while (done < AMOUNT_VALUES) {
+            size_t length = mvshm_sync(shm);
+            const uint64_t* values = mvshm_mvec(shm);
+            if (done == length) sched_yield();
+            for (; done < length; done++) sum += values[done];
+        }
+        _exit(sum != expectedSum());
+    }
+    for (uint64_t i = 0; i < AMOUNT_VALUES; i += BATCH) {
+        size_t capacity = mvcap(mvshm_mvec(shm));
+        if (i + BATCH > capacity) assert(mvshm_resize(shm, capacity * 2));
+        uint64_t* values = mvshm_mvec(shm);
+        for (size_t j = 0; j < BATCH; j++) values[i + j] = i + j;
+        mvshm_publish(shm, i + BATCH);
+    }
+    waitReaders(pids);
+    mvshm_close(shm);
+    return now() - start;
+}
+
+int main(void) {
+    double megabytes = AMOUNT_VALUES * sizeof(uint64_t) / 1e6;
+    printf("%.0f MB to %zu readers\n", megabytes, READERS);
+    double seconds = measurePipe();
+    printf("pipe:  %.3f s, %.0f MB/s\n", seconds, megabytes / seconds);
+    seconds = measureShm();
+    printf("mvshm: %.3f s, %.0f MB/s\n", seconds, megabytes / seconds);
+}
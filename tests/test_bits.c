@@ -0,0 +1,96 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#define MVEC_IMPLEMENTATION
+#define MVBITS_IMPLEMENTATION
+#include "mvbits.h"
+
+static const size_t AMOUNT_BITS = 100000;
+
+// Checks popcount, rank and select against the reference char flags
+static void assert_matches(mvbits_t* bits, const char* flags) {
+    assert(mvbits_index(bits));
+    size_t count = 0;
+    for (size_t i = 0; i < mvbits_len(bits); i++) {
+        assert(mvbits_test(bits, i) == flags[i]);
+        assert(mvbits_rank(bits, i) == count);
+        if (flags[i]) {
+            assert(mvbits_select(bits, count) == i);
+            count++;
+        }
+    }
+    assert(mvbits_rank(bits, mvbits_len(bits)) == count);
+    assert(mvbits_select(bits, count) == mvbits_len(bits));
+    assert(mvbits_popcount(bits) == count);
+}
+
+int main(void) {
+    srand(1337);
+    mvdef char* flags = mvalloc(AMOUNT_BITS, sizeof(char));
+    mvdef char* other_flags = mvalloc(AMOUNT_BITS, sizeof(char));
+    assert(flags && other_flags);
+    mvbits_t* bits = mvbits_alloc(0);
+    mvbits_t* other = mvbits_alloc(AMOUNT_BITS);
+    assert(bits && other);
+    assert(mvbits_cap(other) >= AMOUNT_BITS);
+
+    // The first half gets indexed before the second one is appended
+    for (size_t i = 0; i < AMOUNT_BITS; i++) {
+        if (i == AMOUNT_BITS / 2) assert_matches(bits, flags);
+        flags[i] = rand() % 3 == 0;
+        other_flags[i] = rand() % 2 == 0;
+        assert((bits = mvbits_push(bits, flags[i])));
+        assert((other = mvbits_push(other, other_flags[i])));
+        *mvlen(flags) += 1;
+    }
+    assert(mvbits_len(bits) == AMOUNT_BITS);
+    assert_matches(bits, flags);
+
+    for (size_t i = 0; i < AMOUNT_BITS; i += 7) {
+        mvbits_flip(bits, i);
+        flags[i] ^= 1;
+    }
+    for (size_t i = 3; i < AMOUNT_BITS; i += 1000) {
+        mvbits_set(bits, i, 1);
+        flags[i] = 1;
+    }
+    assert_matches(bits, flags);
+
+    mvbits_and(bits, other);
+    for (size_t i = 0; i < AMOUNT_BITS; i++) flags[i] &= other_flags[i];
+    assert_matches(bits, flags);
+    mvbits_or(bits, other);
+    for (size_t i = 0; i < AMOUNT_BITS; i++) flags[i] |= other_flags[i];
+    assert_matches(bits, flags);
+    mvbits_xor(bits, other);
+    for (size_t i = 0; i < AMOUNT_BITS; i++) flags[i] ^= other_flags[i];
+    assert_matches(bits, flags);
+    mvbits_flip(bits, 10);
+    flags[10] ^= 1;
+    mvbits_andnot(other, bits);
+    for (size_t i = 0; i < AMOUNT_BITS; i++) other_flags[i] &= !flags[i];
+    assert_matches(other, other_flags);
+
+    // Shrinking clears the bits past the new length
+    assert((bits = mvbits_resize(bits, 1000)));
+    assert(mvbits_len(bits) == 1000);
+    *mvlen(flags) = 1000;
+    assert_matches(bits, flags);
+    assert((bits = mvbits_resize(bits, 70)));
+    assert((bits = mvbits_resize(bits, 2000)));
+    assert(mvbits_len(bits) == 70 && mvbits_cap(bits) >= 2000);
+    *mvlen(flags) = 70;
+    assert_matches(bits, flags);
+
+    fprintf(
+            stderr,
+            "%zu flags take %zu bytes as chars and %zu bytes as bits\n",
+            AMOUNT_BITS, mvsize(other_flags), mvsize(other)
+            );
+
+    mvbits_free(bits);
+    mvbits_free(other);
+    mvfree(flags);
+    mvfree(other_flags);
+}
@@ -0,0 +1,75 @@
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define MVEC_CUSTOM_ALLOCATORS
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+
+static size_t callocs = 0;
+static size_t mallocs = 0;
+
+static void* counting_calloc(size_t count, size_t size) {
+    callocs++;
+    return calloc(count, size);
+}
+
+// Returns dirty memory so the test notices if it's not zeroed
+static void* dirty_malloc(size_t size) {
+    mallocs++;
+    void* ptr = malloc(size);
+    if (ptr) memset(ptr, 0xA5, size);
+    return ptr;
+}
+
+static void assert_zeroed(const char* bytes, size_t from, size_t to) {
+    for (size_t i = from; i < to; i++)
+        assert(bytes[i] == 0);
+}
+
+int main(void) {
+    // Without the calloc() hook the memory is zeroed by the library
+    mvec_setAllocator(dirty_malloc, realloc, free);
+    mvdef int* iv = mvcalloc(1000, sizeof(int));
+    assert(iv);
+    assert(mallocs == 1 && callocs == 0);
+    assert(*mvlen(iv) == 0 && mvcap(iv) == 1000 && mvelsz(iv) == sizeof(int));
+    assert_zeroed((const char*)iv, 0, mvcap(iv) * mvelsz(iv));
+    mvfree(iv);
+
+    mvec_setCalloc(counting_calloc);
+    mvdef double* dv = mvcalloc(1 << 20, sizeof(double));
+    assert(dv);
+    assert(mallocs == 1 && callocs == 1);
+    assert_zeroed((const char*)dv, 0, mvcap(dv) * mvelsz(dv));
+
+    // Only the added tail gets zeroed on growth
+    dv[0] = 1.5;
+    dv[mvcap(dv) - 1] = 2.5;
+    *mvlen(dv) = mvcap(dv);
+    mvdef double* grown = mvresize_zeroed(dv, mvcap(dv) * 2 + 3);
+    assert(grown);
+    dv = grown;
+    assert(dv[0] == 1.5 && dv[(1 << 20) - 1] == 2.5);
+    assert(*mvlen(dv) == 1 << 20);
+    assert_zeroed(
+            (const char*)dv,
+            (1 << 20) * sizeof(double),
+            mvcap(dv) * sizeof(double)
+            );
+
+    // Shrinking works the same as mvresize()
+    grown = mvresize_zeroed(dv, 16);
+    assert(grown);
+    dv = grown;
+    assert(mvcap(dv) == 16 && *mvlen(dv) == 16 && dv[0] == 1.5);
+    mvfree(dv);
+
+    // Setting an allocator resets the hook
+    mvec_setAllocator(dirty_malloc, realloc, free);
+    mvdef char* cv = mvcalloc(0, 1);
+    assert(cv);
+    assert(mallocs == 2 && callocs == 1);
+    mvfree(cv);
+    fprintf(stderr, "mallocs: %zu, callocs: %zu\n", mallocs, callocs);
+}
@@ -0,0 +1,191 @@
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#ifdef MVEC_HAS_TBB
+#include <execution>
+#endif
+#define MVEC_CUSTOM_ALLOCATORS
+#define MVEC_IMPLEMENTATION
+#include "mvec.hpp"
+#define MVBITS_IMPLEMENTATION
+#include "mvbits.h"
+
+static std::size_t allocations = 0;
+
+static void* counting_malloc(std::size_t bytes) {
+    allocations++;
+    return std::malloc(bytes);
+}
+
+static void* counting_realloc(void* ptr, std::size_t bytes) {
+    if (!ptr) allocations++;
+    return std::realloc(ptr, bytes);
+}
+
+static std::size_t frees = 0;
+
+static void counting_free(void* ptr) {
+    frees++;
+    std::free(ptr);
+}
+
+// Counts live objects to catch leaks and double destructions
+struct Tracked {
+    static int alive;
+    std::string name;
+    explicit Tracked(std::string n) : name(std::move(n)) { alive++; }
+    Tracked(const Tracked& other) : name(other.name) { alive++; }
+    Tracked(Tracked&& other) noexcept : name(std::move(other.name)) {
+        alive++;
+    }
+    Tracked& operator=(const Tracked&) = default;
+    Tracked& operator=(Tracked&&) noexcept = default;
+    ~Tracked() { alive--; }
+};
+int Tracked::alive = 0;
+
+// Throws when it runs out of copies
+struct Boom {
+    static int alive;
+    static int copies_left;
+    Boom() { alive++; }
+    Boom(const Boom&) {
+        if (!copies_left--) throw std::runtime_error("boom");
+        alive++;
+    }
+    ~Boom() { alive--; }
+};
+int Boom::alive = 0;
+int Boom::copies_left = 0;
+
+static_assert(!mv::is_trivially_relocatable<Tracked>::value);
+static_assert(mv::is_trivially_relocatable<int>::value);
+
+// unique_ptr only holds a pointer, so relocating its bytes is safe
+template <>
+struct mv::is_trivially_relocatable<std::unique_ptr<int>> : std::true_type {};
+
+int main() {
+    mvec_setAllocator(counting_malloc, counting_realloc, counting_free);
+
+    mv::mvec<int> iv;
+    assert(iv.empty() && !iv.data());
+    for (int i = 0; i < 1000; i++)
+        iv.push_back(1000 - i);
+    assert(iv.size() == 1000);
+    // Trivially relocatable elements grow with mvresize() only
+    assert(allocations == 1);
+    // The wrapped pointer is a regular mvec
+    assert(*mvlen(iv.get()) == 1000 && mvelsz(iv.get()) == sizeof(int));
+
+#ifdef MVEC_HAS_TBB
+    std::sort(std::execution::par_unseq, iv.begin(), iv.end());
+#else
+    std::sort(iv.begin(), iv.end());
+#endif
+    assert(std::is_sorted(iv.begin(), iv.end()));
+    assert(std::accumulate(iv.begin(), iv.end(), 0) == 500500);
+
+    // Moves do not allocate
+    mv::mvec<int> moved = std::move(iv);
+    assert(iv.empty() && moved.size() == 1000);
+    mv::mvec<int> assigned;
+    assigned = std::move(moved);
+    assert(allocations == 1);
+    assert(assigned.front() == 1 && assigned.back() == 1000);
+
+    mv::mvec<int> copy = assigned;
+    assert(allocations == 2);
+    assert(copy.size() == 1000 && copy.data() != assigned.data());
+
+    copy.erase(copy.begin(), copy.begin() + 10);
+    copy.insert(copy.begin(), -1);
+    assert(copy.size() == 991 && copy[0] == -1 && copy[1] == 11);
+    copy.resize(5);
+    copy.shrink_to_fit();
+    assert(copy.capacity() == 5);
+
+    {
+        mv::mvec<Tracked> tv;
+        for (int i = 0; i < 100; i++)
+            tv.emplace_back(std::to_string(i));
+        assert(Tracked::alive == 100);
+        tv.insert(tv.begin() + 50, Tracked("inserted"));
+        tv.erase(tv.begin());
+        assert(tv.size() == 100 && Tracked::alive == 100);
+        assert(tv[0].name == "1" && tv[49].name == "inserted");
+        mv::mvec<Tracked> tv_copy = tv;
+        assert(Tracked::alive == 200 && tv_copy[99].name == "99");
+        tv_copy.resize(10, Tracked("filler"));
+        tv_copy.resize(20, Tracked("filler"));
+        assert(tv_copy[19].name == "filler" && Tracked::alive == 120);
+        tv.clear();
+        assert(Tracked::alive == 20);
+    }
+    assert(Tracked::alive == 0);
+
+    mv::mvec<std::unique_ptr<int>> pointers;
+    for (int i = 0; i < 100; i++)
+        pointers.emplace_back(std::make_unique<int>(i));
+    pointers.erase(pointers.begin() + 10);
+    assert(*pointers[10] == 11 && *pointers.back() == 99);
+
+    mv::mvec<std::string> strings = { "monolithic", "vector" };
+    assert(strings.size() == 2 && strings.at(1) == "vector");
+
+    // Pushing an element of a full vector into itself reads it before growing
+    {
+        mv::mvec<int> ints = { 7 };
+        assert(ints.size() == ints.capacity());
+        ints.push_back(ints[0]);
+        ints.resize(ints.capacity() + 5, ints[1]);
+        assert(ints.size() == 7 && ints[6] == 7);
+        mv::mvec<Tracked> names = { Tracked("self") };
+        assert(names.size() == names.capacity());
+        names.push_back(names[0]);
+        names.emplace_back(names.back());
+        names.resize(names.capacity() + 5, names[2]);
+        assert(names.size() == 9 && Tracked::alive == 9);
+        assert(names[1].name == "self" && names[8].name == "self");
+    }
+    assert(Tracked::alive == 0);
+
+    // A throwing copy in a constructor doesn't leak the chunk
+    {
+        std::size_t live = allocations - frees;
+        Boom::copies_left = 1;
+        try {
+            mv::mvec<Boom> booms = { Boom(), Boom() };
+            assert(false);
+        } catch (const std::runtime_error&) {}
+        assert(allocations - frees == live && Boom::alive == 0);
+        Boom::copies_left = 2;
+        mv::mvec<Boom> booms = { Boom(), Boom() };
+        Boom::copies_left = 1;
+        try {
+            mv::mvec<Boom> copy = booms;
+            assert(false);
+        } catch (const std::runtime_error&) {}
+        assert(allocations - frees == live + 1 && Boom::alive == 2);
+    }
+
+    // mvbits.h compiles as C++ too
+    mvbits_t* evens = mvbits_alloc(130);
+    mvbits_t* thirds = mvbits_alloc(130);
+    assert(evens && thirds);
+    for (int i = 0; i < 130; i++) {
+        assert((evens = mvbits_push(evens, i % 2 == 0)));
+        assert((thirds = mvbits_push(thirds, i % 3 == 0)));
+    }
+    mvbits_and(evens, thirds);
+    assert(mvbits_popcount(evens) == 22 && mvbits_test(evens, 126));
+    mvbits_free(evens);
+    mvbits_free(thirds);
+
+    std::fprintf(stderr, "Allocations made: %zu\n", allocations);
+}
@@ -5,6 +5,17 @@
 #define MVEC_IMPLEMENTATION
 #include "mvec.h"
 
+static size_t other_frees = 0;
+
+static void* other_malloc(size_t bytes) {
+    return malloc(bytes);
+}
+
+static void other_free(void* ptr) {
+    other_frees++;
+    free(ptr);
+}
+
 int main(void) {
     mvec_setAllocator(malloc, realloc, free);
     mvdef int* iv = mvalloc(23, sizeof(int));
@@ -41,5 +52,14 @@ int main(void) {
             iv, mvcap(iv), mvlen(iv), mvsize(iv)
             );
 
+    // A vector allocated like another one keeps the other one's allocator
+    mvec_setAllocator(other_malloc, realloc, other_free);
+    mvdef int* like = mvalloc_like(iv, 5);
+    assert(like);
+    assert(mvcap(like) == 5 && *mvlen(like) == 0);
+    assert(mvelsz(like) == sizeof(int) && mvhead(like)->free == free);
+    mvfree(like);
+    assert(other_frees == 0);
+
     mvfree(iv);
 }
@@ -4,7 +4,28 @@
 #include <string.h>
 #define MVEC_CUSTOM_MEMFUNCS
 #define MVEC_IMPLEMENTATION
-#include "mvec.h"
+#define MVSORTED_IMPLEMENTATION
+#include "mvsorted.h"
+
+static size_t copies = 0, moves = 0;
+
+static void* counting_memcpy(
+        void* restrict dest, const void* restrict src, size_t bytes
+        )
+{
+    copies++;
+    return memcpy(dest, src, bytes);
+}
+
+static void* counting_memmove(void* dest, const void* src, size_t bytes) {
+    moves++;
+    return memmove(dest, src, bytes);
+}
+
+static int cmp_int(const void* a, const void* b) {
+    int x = *(const int*)a, y = *(const int*)b;
+    return (x > y) - (x < y);
+}
 
 int main(void) {
     mvec_setMemcpy(memcpy);
@@ -52,4 +73,16 @@ int main(void) {
     mvfree(iv);
     mvfree(bigger_iv);
     mvfree(smaller_iv);
+
+    // Companion headers copy and move elements with the current functions too
+    mvec_setMemcpy(counting_memcpy);
+    mvec_setMemmove(counting_memmove);
+    mvdef int* set = mvalloc(4, sizeof(int));
+    assert(set);
+    int values[] = { 5, 1, 3 };
+    for (size_t i = 0; i < 3; i++)
+        assert((set = mvsorted_insert(set, &values[i], cmp_int)));
+    assert(set[0] == 1 && set[1] == 3 && set[2] == 5);
+    assert(copies == 3 && moves == 2);
+    mvfree(set);
 }
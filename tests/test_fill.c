@@ -0,0 +1,46 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+
+static const size_t ELEMENT_SIZES[] = {1, 2, 3, 4, 8, 12, 16, 32, 40, 100};
+static const size_t CAPACITIES[] = {0, 1, 7, 8, 31, 33, 1000};
+
+int main(void) {
+    unsigned char pattern[100];
+    for (size_t i = 0; i < sizeof(pattern); i++)
+        pattern[i] = (unsigned char)(i * 7 + 1);
+
+    for (size_t s = 0; s < sizeof(ELEMENT_SIZES) / sizeof(size_t); s++) {
+        for (size_t c = 0; c < sizeof(CAPACITIES) / sizeof(size_t); c++) {
+            size_t element_size = ELEMENT_SIZES[s];
+            // A guard element past the capacity must stay untouched, so the
+            // vector claims a capacity smaller than its chunk by one element
+            mvdef unsigned char* v = mvalloc(CAPACITIES[c] + 1, element_size);
+            assert(v);
+            memset(v, 0, mvsize(v) - sizeof(MvecHeader));
+            mvhead(v)->capacity = CAPACITIES[c];
+            *mvlen(v) = CAPACITIES[c] / 2;
+            mvfill(v, pattern);
+            assert(*mvlen(v) == CAPACITIES[c] / 2);
+            for (size_t i = 0; i < mvcap(v); i++)
+                assert(!memcmp(v + i * element_size, pattern, element_size));
+            const unsigned char* guard = v + mvcap(v) * element_size;
+            for (size_t i = 0; i < element_size; i++)
+                assert(guard[i] == 0);
+            mvfree(v);
+        }
+    }
+
+    // Typical use: a vector of the same value
+    mvdef int* iv = mvalloc(4096, sizeof(int));
+    assert(iv);
+    int minus_one = -1;
+    mvfill(iv, &minus_one);
+    *mvlen(iv) = mvcap(iv);
+    for (size_t i = 0; i < *mvlen(iv); i++)
+        assert(iv[i] == -1);
+    mvfree(iv);
+    fputs("mvfill works for all the element sizes\n", stderr);
+}
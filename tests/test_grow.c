@@ -0,0 +1,76 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVGROW_IMPLEMENTATION
+#include "mvgrow.h"
+
+static const size_t AMOUNT_VALUES = 100000;
+static const size_t STEP_BYTES = 64;
+
+int main(void) {
+    mvgrow_t* grow = mvgrow_alloc(0, sizeof(uint32_t), STEP_BYTES);
+    assert(grow);
+    assert(mvgrow_len(grow) == 0 && mvgrow_elsz(grow) == sizeof(uint32_t));
+    assert(grow->step == STEP_BYTES / sizeof(uint32_t));
+
+    // No push copies more than the step, and every element stays reachable
+    size_t growths = 0;
+    for (uint32_t i = 0; i < AMOUNT_VALUES; i++) {
+        size_t capacity = mvgrow_cap(grow);
+        size_t migrated = grow->migrated;
+        int migrating = mvgrow_migrating(grow);
+        assert(mvgrow_push(grow, &i));
+        if (mvgrow_cap(grow) != capacity) {
+            growths++;
+            assert(!migrating);
+            assert(mvgrow_cap(grow) == (capacity ? capacity * 2 : 1));
+            migrated = 0;
+        }
+        if (mvgrow_migrating(grow))
+            assert(grow->migrated - migrated <= grow->step);
+        assert(mvgrow_len(grow) == i + 1u);
+        assert(*(uint32_t*)mvgrow_at(grow, i / 2) == i / 2);
+        assert(*(uint32_t*)mvgrow_at(grow, i) == i);
+    }
+
+    // Migrated old mvec waits for finishing at idle time to be freed
+    assert(grow->old && !mvgrow_migrating(grow));
+    mvgrow_finish(grow);
+    assert(!grow->old && mvgrow_migrate(grow, 1) == 0);
+    while (!mvgrow_migrating(grow)) {
+        uint32_t value = (uint32_t)mvgrow_len(grow);
+        assert(mvgrow_push(grow, &value));
+    }
+    size_t left = mvgrow_migrate(grow, 1);
+    assert(left && mvgrow_migrate(grow, 0) == left);
+    mvgrow_finish(grow);
+    assert(!grow->old && !mvgrow_migrating(grow));
+    for (size_t i = 0; i < mvgrow_len(grow); i++)
+        assert(*(uint32_t*)mvgrow_at(grow, i) == i);
+
+    // Popping below the migrated part ends the migration
+    while (!mvgrow_migrating(grow)) {
+        uint32_t value = (uint32_t)mvgrow_len(grow);
+        assert(mvgrow_push(grow, &value));
+    }
+    size_t length = mvgrow_len(grow);
+    while (mvgrow_len(grow) > grow->migrated) mvgrow_pop(grow);
+    assert(!mvgrow_migrating(grow));
+    for (size_t i = 0; i < mvgrow_len(grow); i++)
+        assert(*(uint32_t*)mvgrow_at(grow, i) == i);
+
+    // Released vector is an ordinary mvec
+    mvdef uint32_t* values = mvgrow_release(grow);
+    assert(*mvlen(values) < length);
+    for (size_t i = 0; i < *mvlen(values); i++) assert(values[i] == i);
+    mvfree(values);
+
+    grow = mvgrow_alloc(4, sizeof(uint32_t), 0);
+    assert(grow && grow->step == 1);
+    for (uint32_t i = 0; i < 5; i++) assert(mvgrow_push(grow, &i));
+    assert(mvgrow_migrating(grow));
+    mvgrow_free(grow);
+    fprintf(stderr, "%zu growths\n", growths);
+}
@@ -0,0 +1,110 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define MVEC_CUSTOM_ALLOCATORS
+#define MVEC_IMPLEMENTATION
+#define MVHASH_IMPLEMENTATION
+#include "mvhash.h"
+
+static size_t allocations = 0;
+
+static void* counting_malloc(size_t bytes) {
+    allocations++;
+    return malloc(bytes);
+}
+
+typedef struct {
+    char name[12];
+    int32_t id;
+} Key;
+
+// Hashes the id only, so names with equal ids collide on purpose
+static size_t key_hash(const void* key, size_t key_size) {
+    (void)key_size;
+    return (size_t)((const Key*)key)->id * 0x9e3779b97f4a7c15ull;
+}
+
+static int key_cmp(const void* _a, const void* _b, size_t key_size) {
+    (void)key_size;
+    const Key* a = _a;
+    const Key* b = _b;
+    return a->id != b->id || strcmp(a->name, b->name);
+}
+
+int main(void) {
+    mvec_setAllocator(counting_malloc, realloc, free);
+    mvhash_t* map = mvhash_alloc(0, sizeof(uint64_t), sizeof(int), NULL, NULL);
+    assert(map);
+    assert(mvhash_len(map) == 0 && mvhash_cap(map) == MVHASH_GROUP);
+
+    for (uint64_t i = 0; i < 10000; i++) {
+        int value = (int)i * 3;
+        assert((map = mvhash_put(map, &i, &value)));
+    }
+    assert(mvhash_len(map) == 10000);
+    // Growth reallocates the same chunk instead of allocating a new table
+    assert(allocations == 1);
+    for (uint64_t i = 0; i < 10000; i++) {
+        int* value = mvhash_get(map, &i);
+        assert(value && *value == (int)i * 3);
+    }
+    uint64_t missing = 10000;
+    assert(!mvhash_get(map, &missing));
+
+    // Remove the odd keys, then overwrite and insert more so deleted slots
+    // get reused and cleaned up
+    for (uint64_t i = 1; i < 10000; i += 2)
+        assert(mvhash_remove(map, &i));
+    assert(!mvhash_remove(map, &(uint64_t){ 1 }));
+    assert(mvhash_len(map) == 5000);
+    size_t capacity = mvhash_cap(map);
+    for (size_t round = 0; round < 4; round++) {
+        for (uint64_t i = 10000; i < 15000; i++) {
+            int value = -(int)i;
+            assert((map = mvhash_put(map, &i, &value)));
+        }
+        for (uint64_t i = 10000; i < 15000; i++)
+            assert(mvhash_remove(map, &i));
+    }
+    assert(mvhash_cap(map) == capacity);
+
+    size_t visited = 0;
+    for (size_t s = mvhash_next(map, 0); s < mvhash_cap(map);
+            s = mvhash_next(map, s + 1)) {
+        uint64_t key = *(uint64_t*)mvhash_key(map, s);
+        assert(key % 2 == 0 && *(int*)mvhash_value(map, s) == (int)key * 3);
+        visited++;
+    }
+    assert(visited == 5000);
+
+    assert((map = mvhash_reserve(map, 100000)));
+    assert(mvhash_maxLength(mvhash_cap(map)) >= 100000);
+    for (uint64_t i = 0; i < 10000; i += 2)
+        assert(*(int*)mvhash_get(map, &i) == (int)i * 3);
+
+    fprintf(
+            stderr,
+            "Slots: %zu\n"
+            "Whole size: %zu\n",
+            mvhash_cap(map), mvsize(map)
+            );
+    mvfree(map);
+
+    // Custom hash and comparator for keys with padding
+    mvhash_t* names = mvhash_alloc(4, sizeof(Key), sizeof(double),
+            key_hash, key_cmp);
+    assert(names);
+    for (int32_t i = 0; i < 100; i++) {
+        Key key = { .id = i % 10 };
+        snprintf(key.name, sizeof(key.name), "name%d", i);
+        double value = i;
+        assert((names = mvhash_put(names, &key, &value)));
+    }
+    assert(mvhash_len(names) == 100);
+    Key key = { .id = 7 };
+    snprintf(key.name, sizeof(key.name), "name%d", 57);
+    assert(*(double*)mvhash_get(names, &key) == 57.0);
+    mvfree(names);
+}
@@ -0,0 +1,163 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVHEAP_IMPLEMENTATION
+#include "mvheap.h"
+
+static const size_t AMOUNT_VALUES = 20000;
+
+typedef struct {
+    uint32_t priority;
+    uint32_t id;
+} Task;
+
+// Larger than the elements mvheap_heapify() keeps on the stack
+typedef struct {
+    uint64_t key;
+    char payload[120];
+} Blob;
+
+static int taskComp(const void* _a, const void* _b) {
+    const Task* a = _a;
+    const Task* b = _b;
+    return (a->priority > b->priority) - (a->priority < b->priority);
+}
+
+static int blobComp(const void* _a, const void* _b) {
+    const Blob* a = _a;
+    const Blob* b = _b;
+    return (a->key > b->key) - (a->key < b->key);
+}
+
+static uint64_t next(uint64_t* state) {
+    *state ^= *state << 13;
+    *state ^= *state >> 7;
+    *state ^= *state << 17;
+    return *state;
+}
+
+static void assertHeap(mvec_t* mvec, cmpfunc_t cmp) {
+    const char* heap = mvec;
+    size_t element_size = mvelsz(mvec);
+    for (size_t i = 1; i < *mvlen(mvec); i++) {
+        const char* parent = heap + (i - 1) / MVHEAP_ARITY * element_size;
+        assert(cmp(parent, heap + i * element_size) <= 0);
+    }
+}
+
+static void assertHeapU64(mvdef uint64_t* mvec) {
+    for (size_t i = 1; i < *mvlen(mvec); i++)
+        assert(mvec[(i - 1) / MVHEAP_ARITY] <= mvec[i]);
+}
+
+int main(void) {
+    uint64_t state = 88172645463325252ull;
+
+    // Pushes and pops come out in order
+    mvdef Task* tasks = mvalloc(1, sizeof(Task));
+    assert(tasks && !mvheap_top(tasks));
+    assert(!mvheap_pop(tasks, NULL, taskComp));
+    for (uint32_t i = 0; i < AMOUNT_VALUES; i++) {
+        Task task = {(uint32_t)(next(&state) % 1000), i};
+        tasks = mvheap_push(tasks, &task, taskComp);
+        assert(tasks);
+    }
+    assertHeap(tasks, taskComp);
+    Task top, previous = {0, 0};
+    for (size_t i = 0; i < AMOUNT_VALUES / 2; i++) {
+        assert(mvheap_pop(tasks, &top, taskComp));
+        assert(top.priority >= previous.priority);
+        previous = top;
+    }
+    assertHeap(tasks, taskComp);
+
+    // Replacing the top keeps the heap
+    for (size_t i = 0; i < AMOUNT_VALUES; i++) {
+        Task task = {(uint32_t)(next(&state) % 2000), (uint32_t)i};
+        Task least = *(Task*)mvheap_top(tasks);
+        mvheap_replaceTop(tasks, &task, &top, taskComp);
+        assert(top.priority == least.priority);
+    }
+    assertHeap(tasks, taskComp);
+
+    // Small batches are pushed one by one, large ones heapified together
+    Task batch[64];
+    for (size_t i = 0; i < 64; i++)
+        batch[i] = (Task){(uint32_t)(next(&state) % 1000), (uint32_t)i};
+    size_t length = *mvlen(tasks);
+    tasks = mvheap_pushMany(tasks, batch, 64, taskComp);
+    assert(tasks && *mvlen(tasks) == length + 64);
+    assertHeap(tasks, taskComp);
+    mvfree(tasks);
+    tasks = mvalloc(2, sizeof(Task));
+    assert(tasks);
+    tasks = mvheap_pushMany(tasks, batch, 64, taskComp);
+    assert(tasks && *mvlen(tasks) == 64);
+    assertHeap(tasks, taskComp);
+    for (size_t i = 0; i < 64; i++) assert(mvheap_pop(tasks, NULL, taskComp));
+    assert(!mvheap_pop(tasks, NULL, taskComp));
+    mvfree(tasks);
+
+    // Large elements are heapified through the spare capacity or a temporary
+    // mvec when the vector is full
+    for (size_t spare = 0; spare < 2; spare++) {
+        mvdef Blob* blobs = mvalloc(1000 + spare, sizeof(Blob));
+        assert(blobs);
+        for (size_t i = 0; i < 1000; i++) {
+            blobs[i].key = next(&state) % 100;
+            blobs[i].payload[0] = (char)blobs[i].key;
+        }
+        *mvlen(blobs) = 1000;
+        assert(mvheap_heapify(blobs, blobComp));
+        assertHeap(blobs, blobComp);
+        Blob blob;
+        uint64_t last = 0;
+        while (mvheap_pop(blobs, &blob, blobComp)) {
+            assert(blob.key >= last && blob.payload[0] == (char)blob.key);
+            last = blob.key;
+        }
+        mvfree(blobs);
+    }
+
+    // Integer fast paths agree with the generic functions
+    mvdef uint64_t* keys = mvalloc(4, sizeof(uint64_t));
+    assert(keys);
+    uint64_t* values = malloc(AMOUNT_VALUES * sizeof(uint64_t));
+    assert(values);
+    for (size_t i = 0; i < AMOUNT_VALUES; i++)
+        values[i] = next(&state) % 5000;
+    keys = mvheap_pushManyU64(keys, values, AMOUNT_VALUES / 2);
+    assert(keys);
+    assertHeapU64(keys);
+    for (size_t i = AMOUNT_VALUES / 2; i < AMOUNT_VALUES; i++) {
+        keys = mvheap_pushU64(keys, values[i]);
+        assert(keys);
+    }
+    assertHeapU64(keys);
+    keys = mvheap_pushManyU64(keys, values, 100);
+    assert(keys && *mvlen(keys) == AMOUNT_VALUES + 100);
+    assertHeapU64(keys);
+    for (size_t i = 0; i < AMOUNT_VALUES; i++) {
+        uint64_t least = keys[0];
+        assert(mvheap_replaceTopU64(keys, values[i] + 1) == least);
+    }
+    assertHeapU64(keys);
+    uint64_t key, last = 0;
+    size_t popped = 0;
+    while (mvheap_popU64(keys, &key)) {
+        assert(key >= last);
+        last = key;
+        popped++;
+    }
+    assert(popped == AMOUNT_VALUES + 100);
+    for (size_t i = 0; i < AMOUNT_VALUES; i++) keys[i] = values[i];
+    *mvlen(keys) = AMOUNT_VALUES;
+    mvheap_heapifyU64(keys);
+    assertHeapU64(keys);
+    free(values);
+    mvfree(keys);
+    fprintf(stderr, "arity %d\n", MVHEAP_ARITY);
+}
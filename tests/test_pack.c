@@ -0,0 +1,117 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVPACK_IMPLEMENTATION
+#include "mvpack.h"
+
+static const size_t LENGTHS[] = {0, 1, 2, 127, 128, 129, 1000, 100000};
+
+static uint64_t state = 88172645463325252u;
+
+static uint64_t next_random(void) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+// Fills the vector up to its capacity with one of the value shapes
+static void generate(mvec_t* mvec, int shape) {
+    size_t element_size = mvelsz(mvec);
+    uint64_t value = next_random();
+    for (size_t i = 0; i < mvcap(mvec); i++) {
+        switch (shape) {
+        case 0: value += next_random() % 16; break;          // sorted ids
+        case 1: value += next_random() % 7 - 3; break;       // slowly varying
+        case 2: value = next_random(); break;                // noise
+        case 3: break;                                       // constant
+        default: value -= 1000; break;                       // descending
+        }
+        memcpy((char*)mvec + i * element_size, &value, element_size);
+    }
+    *mvlen(mvec) = mvcap(mvec);
+}
+
+static void check(size_t length, size_t element_size, int shape) {
+    mvec_t* mvec = mvalloc(length, element_size);
+    assert(mvec);
+    generate(mvec, shape);
+    mvpack_t* pack = mvec_compress(mvec);
+    assert(pack);
+    assert(mvpack_len(pack) == length);
+    assert(mvpack_elsz(pack) == element_size);
+    assert(mvpack_blocks(pack) == (length + MVPACK_BLOCK - 1) / MVPACK_BLOCK);
+
+    mvec_t* back = mvec_decompress(pack);
+    assert(back);
+    assert(*mvlen(back) == length && mvelsz(back) == element_size);
+    assert(!memcmp(back, mvec, length * element_size));
+
+    for (size_t i = 0; i < length; i += 1 + length / 50) {
+        uint64_t value = 0;
+        memcpy(&value, (char*)mvec + i * element_size, element_size);
+        assert(mvpack_get(pack, i) == value);
+    }
+
+    // Streaming into a reused vector, a few blocks at a time
+    *mvlen(back) = 0;
+    mvec_t* piece = mvalloc(0, element_size);
+    assert(piece);
+    for (size_t b = 0; b < mvpack_blocks(pack); b += 3) {
+        size_t count = mvpack_blocks(pack) - b < 3
+            ? mvpack_blocks(pack) - b : 3;
+        *mvlen(piece) = 0;
+        piece = mvpack_decode(pack, b, count, piece);
+        assert(piece);
+        assert(!memcmp(
+                    piece,
+                    (char*)mvec + b * MVPACK_BLOCK * element_size,
+                    *mvlen(piece) * element_size
+                    ));
+        back = mvpack_decode(pack, b, count, back);
+        assert(back);
+    }
+    assert(*mvlen(back) == length);
+    assert(!memcmp(back, mvec, length * element_size));
+
+    if (length == 100000 && shape < 2)
+        fprintf(
+                stderr,
+                "%zu-byte values, shape %d: %zu -> %zu bytes\n",
+                element_size, shape,
+                length * element_size, *mvlen(pack)
+               );
+    mvfree(piece);
+    mvfree(back);
+    mvfree(pack);
+    mvfree(mvec);
+}
+
+int main(void) {
+    const size_t element_sizes[] = {2, 4, 8};
+    for (size_t s = 0; s < 3; s++)
+        for (size_t l = 0; l < sizeof(LENGTHS) / sizeof(size_t); l++)
+            for (int shape = 0; shape < 5; shape++)
+                check(LENGTHS[l], element_sizes[s], shape);
+
+    // Sorted ids take a few bits per value
+    mvdef uint32_t* ids = mvalloc(1 << 16, sizeof(uint32_t));
+    assert(ids);
+    for (uint32_t i = 0; i < mvcap(ids); i++)
+        ids[(*mvlen(ids))++] = 1000000 + i * 3 + (i & 1);
+    mvpack_t* pack = mvec_compress(ids);
+    assert(pack);
+    assert(*mvlen(pack) * 8 < *mvlen(ids) * sizeof(uint32_t));
+    mvfree(pack);
+    mvfree(ids);
+
+    // Unsupported element sizes
+    mvdef char* chars = mvalloc(4, 1);
+    assert(chars);
+    assert(!mvec_compress(chars));
+    mvfree(chars);
+}
@@ -0,0 +1,119 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVPAR_IMPLEMENTATION
+#include "mvpar.h"
+
+static const size_t LENGTHS[] = {0, 1, 1000, 1024, 100003, 3000000};
+
+static void mark(void* first, size_t count, size_t index, void* arg) {
+    uint32_t* values = first;
+    (void)arg;
+    for (size_t i = 0; i < count; i++)
+        values[i] = (uint32_t)(index + i);
+}
+
+static void widen_square(void* dest, const void* src, size_t count, void* arg) {
+    uint64_t* to = dest;
+    const uint32_t* from = src;
+    (void)arg;
+    for (size_t i = 0; i < count; i++)
+        to[i] = (uint64_t)from[i] * from[i];
+}
+
+static void add(void* acc, const void* element, void* arg) {
+    (void)arg;
+    *(uint32_t*)acc += *(const uint32_t*)element;
+}
+
+// Composition of affine maps x -> a*x + b, which is not commutative
+typedef struct {
+    uint32_t a, b;
+} Affine;
+
+static void compose(void* acc, const void* element, void* arg) {
+    Affine* f = acc;
+    const Affine* g = element;
+    (void)arg;
+    f->b = g->a * f->b + g->b;
+    f->a = g->a * f->a;
+}
+
+static void check(MvparPool* pool, size_t length) {
+    mvdef uint32_t* values = mvalloc(length, sizeof(uint32_t));
+    assert(values);
+    *mvlen(values) = length;
+    mvpar_forEach(pool, values, mark, NULL);
+    for (size_t i = 0; i < length; i++)
+        assert(values[i] == i);
+
+    mvdef uint64_t* squares = mvalloc(0, sizeof(uint64_t));
+    assert(squares);
+    squares = mvpar_map(pool, squares, values, widen_square, NULL);
+    assert(squares);
+    assert(*mvlen(squares) == length);
+    for (size_t i = 0; i < length; i++)
+        assert(squares[i] == (uint64_t)i * i);
+
+    uint32_t sum = 7, zero = 0;
+    assert(mvpar_reduce(pool, values, &sum, &zero, add, NULL));
+    uint32_t expected = 0;
+    for (size_t i = 0; i < length; i++) expected += (uint32_t)i;
+    assert(sum == expected);
+
+    mvdef Affine* maps = mvalloc(length, sizeof(Affine));
+    assert(maps);
+    for (size_t i = 0; i < length; i++)
+        maps[(*mvlen(maps))++] = (Affine){(uint32_t)(i * 2 + 1), (uint32_t)i};
+    Affine id = {1, 0}, total;
+    assert(mvpar_reduce(pool, maps, &total, &id, compose, NULL));
+
+    for (int exclusive = 0; exclusive < 2; exclusive++) {
+        mvdef Affine* prefixes = mvalloc(1, sizeof(Affine));
+        assert(prefixes);
+        prefixes = mvpar_scan(
+                pool, prefixes, maps, &id, compose, NULL, exclusive
+                );
+        assert(prefixes);
+        assert(*mvlen(prefixes) == length);
+        Affine acc = id;
+        for (size_t i = 0; i < length; i++) {
+            if (!exclusive) compose(&acc, &maps[i], NULL);
+            assert(prefixes[i].a == acc.a && prefixes[i].b == acc.b);
+            if (exclusive) compose(&acc, &maps[i], NULL);
+        }
+        assert(acc.a == total.a && acc.b == total.b);
+        mvfree(prefixes);
+    }
+
+    // In place
+    assert(mvpar_scan(pool, values, values, &zero, add, NULL, 1) == values);
+    expected = 0;
+    for (size_t i = 0; i < length; i++) {
+        assert(values[i] == expected);
+        expected += (uint32_t)i;
+    }
+
+    mvfree(maps);
+    mvfree(squares);
+    mvfree(values);
+}
+
+int main(void) {
+    MvparPool* pool = mvpar_create(4);
+    assert(pool);
+    assert(mvpar_threads(pool) == 4);
+    for (size_t l = 0; l < sizeof(LENGTHS) / sizeof(size_t); l++) {
+        check(pool, LENGTHS[l]);
+        check(NULL, LENGTHS[l]);
+    }
+    mvpar_destroy(pool);
+
+    pool = mvpar_create(0);
+    assert(pool);
+    fprintf(stderr, "Default pool has %zu threads\n", mvpar_threads(pool));
+    check(pool, 3000000);
+    mvpar_destroy(pool);
+}
@@ -0,0 +1,110 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#define MVEC_CUSTOM_ALLOCATORS
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVRCU_IMPLEMENTATION
+#include "mvrcu.h"
+
+#define AMOUNT_READERS 4
+static const size_t AMOUNT_VERSIONS = 2000;
+static const size_t VERSION_LENGTH = 256;
+
+static mvrcu_t* rcu;
+static int done = 0;
+static size_t versions_freed = 0;
+
+// Versions are freed with the function stored in them, even though the
+// allocator gets changed later
+static void versionFree(void* ptr) {
+    __atomic_fetch_add(&versions_freed, 1, __ATOMIC_RELAXED);
+    free(ptr);
+}
+
+static mvec_t* version(uint64_t number) {
+    mvec_setAllocator(malloc, realloc, versionFree);
+    mvdef uint64_t* values = mvalloc(VERSION_LENGTH, sizeof(uint64_t));
+    mvec_setAllocator(malloc, realloc, free);
+    assert(values);
+    for (size_t i = 0; i < VERSION_LENGTH; i++)
+        values[(*mvlen(values))++] = number;
+    return values;
+}
+
+// Every version a reader gets is whole, and they never go back
+static void* reader(void* arg) {
+    size_t* reads = arg;
+    size_t slot = mvrcu_register(rcu);
+    assert(slot != MVRCU_NONE);
+    uint64_t last = 0;
+    while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+        mvdef uint64_t* values = mvrcu_enter(rcu, slot);
+        assert(values && *mvlen(values) == VERSION_LENGTH);
+        uint64_t number = values[0];
+        assert(number >= last);
+        for (size_t i = 0; i < VERSION_LENGTH; i++)
+            assert(values[i] == number);
+        mvrcu_leave(rcu, slot);
+        last = number;
+        (*reads)++;
+    }
+    mvrcu_unregister(rcu, slot);
+    return NULL;
+}
+
+int main(void) {
+    rcu = mvrcu_create(version(0), AMOUNT_READERS);
+    assert(rcu);
+    assert(((uint64_t*)mvrcu_current(rcu))[0] == 0);
+
+    pthread_t threads[AMOUNT_READERS];
+    size_t reads[AMOUNT_READERS] = {0};
+    for (size_t i = 0; i < AMOUNT_READERS; i++)
+        assert(!pthread_create(threads + i, NULL, reader, reads + i));
+    for (uint64_t v = 1; v < AMOUNT_VERSIONS; v++) {
+        assert(mvrcu_publish(rcu, version(v)));
+        if (v % 64 == 0) sched_yield();
+    }
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+    size_t total_reads = 0;
+    for (size_t i = 0; i < AMOUNT_READERS; i++) {
+        assert(!pthread_join(threads[i], NULL));
+        total_reads += reads[i];
+    }
+
+    // With no readers, everything but the published version gets freed
+    mvrcu_synchronize(rcu);
+    assert(*mvlen(rcu->retired) == 0);
+    assert(versions_freed == AMOUNT_VERSIONS - 1);
+    assert(((uint64_t*)mvrcu_current(rcu))[0] == AMOUNT_VERSIONS - 1);
+
+    // A version used by a reader survives until it leaves
+    size_t slot = mvrcu_register(rcu);
+    assert(slot != MVRCU_NONE);
+    mvdef uint64_t* held = mvrcu_enter(rcu, slot);
+    assert(mvrcu_publish(rcu, version(AMOUNT_VERSIONS)));
+    assert(mvrcu_reclaim(rcu) == 1);
+    assert(held[0] == AMOUNT_VERSIONS - 1);
+    mvrcu_leave(rcu, slot);
+    assert(mvrcu_reclaim(rcu) == 0);
+    assert(((uint64_t*)mvrcu_enter(rcu, slot))[0] == AMOUNT_VERSIONS);
+    mvrcu_leave(rcu, slot);
+    mvrcu_unregister(rcu, slot);
+
+    // All the slots can be taken
+    size_t slots[AMOUNT_READERS];
+    for (size_t i = 0; i < AMOUNT_READERS; i++) {
+        slots[i] = mvrcu_register(rcu);
+        assert(slots[i] != MVRCU_NONE);
+    }
+    assert(mvrcu_register(rcu) == MVRCU_NONE);
+    for (size_t i = 0; i < AMOUNT_READERS; i++) mvrcu_unregister(rcu, slots[i]);
+
+    mvrcu_destroy(rcu);
+    assert(versions_freed == AMOUNT_VERSIONS + 1);
+    fprintf(stderr, "%zu reads of %zu versions\n",
+            total_reads, AMOUNT_VERSIONS);
+}
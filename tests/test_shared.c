@@ -0,0 +1,56 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#define MVEC_SHARED
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+
+static const size_t SNAPSHOTS_PER_THREAD = 100000;
+
+// Background reader: takes and drops snapshots while checking the contents
+static void* reader(void* arg) {
+    mvdef int* iv = arg;
+    for (size_t i = 0; i < SNAPSHOTS_PER_THREAD; i++) {
+        mvdef int* snapshot = mvshare(iv);
+        assert(snapshot == iv);
+        assert(snapshot[*mvlen(snapshot) - 1] == 15);
+        mvfree(snapshot);
+    }
+    return NULL;
+}
+
+int main(void) {
+    mvdef int* iv = mvalloc(24, sizeof(int));
+    assert(iv);
+    for (size_t i = 0; i < 16; i++)
+        iv[(*mvlen(iv))++] = i;
+    assert(mvrefs(iv) == 1);
+
+    // The only reference is writable as is
+    assert(mvmut(iv) == iv);
+
+    mvdef int* snapshot = mvshare(iv);
+    assert(snapshot == iv);
+    assert(mvrefs(iv) == 2);
+
+    // Writing to a shared vector detaches the writer's copy
+    mvdef int* writable = mvmut(iv);
+    assert(writable && writable != snapshot);
+    assert(mvrefs(snapshot) == 1 && mvrefs(writable) == 1);
+    assert(mvcap(writable) == 24 && *mvlen(writable) == 16);
+    for (size_t i = 0; i < *mvlen(writable); i++)
+        writable[i] *= 2;
+    assert(snapshot[15] == 15 && writable[15] == 30);
+    mvfree(writable);
+
+    pthread_t threads[4];
+    for (size_t i = 0; i < 4; i++)
+        assert(!pthread_create(&threads[i], NULL, reader, snapshot));
+    for (size_t i = 0; i < 4; i++)
+        assert(!pthread_join(threads[i], NULL));
+    assert(mvrefs(snapshot) == 1);
+
+    fprintf(stderr, "Size of MvecHeader: %zu\n", sizeof(MvecHeader));
+
+    mvfree(snapshot);
+}
@@ -0,0 +1,99 @@
+#define _POSIX_C_SOURCE 200809L
+#include <assert.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVSHM_IMPLEMENTATION
+#include "mvshm.h"
+
+static const size_t AMOUNT_VALUES = 200000;
+
+// Follows the vector grown by the writer until it has all the values
+static void reader(mvshm_t* shm, int ready) {
+    size_t length = mvshm_sync(shm);
+    assert(write(ready, "", 1) == 1);
+    size_t checked = 0;
+    while (checked < AMOUNT_VALUES) {
+        length = mvshm_sync(shm);
+        const uint32_t* values = mvshm_mvec(shm);
+        assert(length <= AMOUNT_VALUES);
+        for (; checked < length; checked++)
+            assert(values[checked] == checked * 7);
+        if (checked < AMOUNT_VALUES) sched_yield();
+    }
+    assert(shm->generation > 0);
+    assert(mvelsz(mvshm_mvec(shm)) == sizeof(uint32_t));
+    mvdef uint32_t* copy = mvcopy(mvshm_mvec(shm), length);
+    assert(copy && *mvlen(copy) == AMOUNT_VALUES);
+    assert(copy[AMOUNT_VALUES - 1] == (AMOUNT_VALUES - 1) * 7);
+    mvfree(copy);
+    mvshm_close(shm);
+}
+
+// Starts a reader process and pushes the values while it reads them
+static void exchange(mvshm_t* shm, const char* name) {
+    int ready[2];
+    assert(!pipe(ready));
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (!pid) {
+        close(ready[0]);
+        if (name) {
+            mvshm_close(shm);
+            shm = mvec_shmOpen(name);
+            assert(shm);
+        }
+        reader(shm, ready[1]);
+        _exit(0);
+    }
+    close(ready[1]);
+    char byte;
+    assert(read(ready[0], &byte, 1) == 1);
+    close(ready[0]);
+    for (uint32_t i = 0; i < AMOUNT_VALUES; i++) {
+        uint32_t value = i * 7;
+        assert(mvshm_push(shm, &value));
+    }
+    int status;
+    assert(waitpid(pid, &status, 0) == pid);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+}
+
+int main(void) {
+    char name[64];
+    snprintf(name, sizeof(name), "/mvec_test_shm_%ld", (long)getpid());
+    assert(!mvec_shmOpen(name));
+    mvshm_t* shm = mvec_shmCreate(name, 1, sizeof(uint32_t));
+    assert(shm);
+    assert(!mvec_shmCreate(name, 1, sizeof(uint32_t)));
+    assert(*mvlen(mvshm_mvec(shm)) == 0 && mvcap(mvshm_mvec(shm)) == 1);
+    assert((uintptr_t)mvshm_mvec(shm) % MVSHM_ALIGNMENT == 0);
+
+    // A reader opened in the same process shares the data
+    mvshm_t* view = mvec_shmOpen(name);
+    assert(view && mvshm_sync(view) == 0);
+    uint32_t value = 42;
+    assert(mvshm_push(shm, &value));
+    assert(mvshm_sync(view) == 1);
+    assert(*(uint32_t*)mvshm_mvec(view) == 42);
+    mvshm_close(view);
+    mvshm_publish(shm, 0);
+
+    exchange(shm, name);
+    assert(mvshm_unlink(name));
+    assert(!mvec_shmOpen(name));
+    fprintf(stderr, "%zu growths\n", (size_t)shm->generation);
+    mvshm_close(shm);
+
+    // Anonymous vectors are shared with the forked processes
+    shm = mvec_shmCreate(NULL, 16, sizeof(uint32_t));
+    assert(shm);
+    exchange(shm, NULL);
+    assert(mvshm_sync(shm) == AMOUNT_VALUES);
+    mvshm_close(shm);
+}
@@ -0,0 +1,74 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#define MVEC_IMPLEMENTATION
+#define MVSOA_IMPLEMENTATION
+#include "mvsoa.h"
+
+static void assert_aligned(mvsoa_t* soa) {
+    for (size_t i = 0; i < mvsoa_cols(soa); i++)
+        assert((uintptr_t)mvsoa_col(soa, i) % MVSOA_ALIGNMENT == 0);
+}
+
+int main(void) {
+    // Records of (id, weight, tag) stored column by column
+    size_t element_sizes[] = { sizeof(int), sizeof(double), sizeof(char) };
+    mvsoa_t* soa = mvsoa_alloc(3, 3, element_sizes);
+    assert(soa);
+    assert(mvsoa_cap(soa) == 3);
+    assert(*mvsoa_len(soa) == 0);
+    assert_aligned(soa);
+
+    for (int i = 0; i < 100; i++) {
+        double weight = i * 0.5;
+        char tag = 'a' + i % 26;
+        const void* row[] = { &i, &weight, &tag };
+        assert((soa = mvsoa_push(soa, row)));
+        assert_aligned(soa);
+    }
+    assert(*mvsoa_len(soa) == 100);
+    assert(mvsoa_cap(soa) == 192);
+
+    int* ids = mvsoa_col(soa, 0);
+    double* weights = mvsoa_col(soa, 1);
+    char* tags = mvsoa_col(soa, 2);
+    for (int i = 0; i < 100; i++)
+        assert(ids[i] == i && weights[i] == i * 0.5 && tags[i] == 'a' + i % 26);
+
+    // Drop rows 10..19 from all the columns at once
+    mvsoa_erase(soa, 10, 10);
+    assert(*mvsoa_len(soa) == 90);
+    assert(ids[9] == 9 && ids[10] == 20 && weights[10] == 10.0);
+    assert(tags[10] == 'a' + 20 % 26);
+
+    // Make room for a row at the front
+    mvsoa_shift(soa, 0, +1);
+    ids[0] = -1; weights[0] = -1.0; tags[0] = '-';
+    assert(*mvsoa_len(soa) == 91);
+    assert(ids[1] == 0 && weights[11] == 10.0);
+
+    assert((soa = mvsoa_resize(soa, 50)));
+    assert_aligned(soa);
+    assert(mvsoa_cap(soa) == 50 && *mvsoa_len(soa) == 50);
+    ids = mvsoa_col(soa, 0);
+    weights = mvsoa_col(soa, 1);
+    tags = mvsoa_col(soa, 2);
+    assert(ids[0] == -1 && weights[0] == -1.0 && tags[0] == '-');
+    assert(ids[49] == 58 && weights[49] == 29.0 && tags[49] == 'a' + 58 % 26);
+
+    assert((soa = mvsoa_resize(soa, 1000)));
+    assert_aligned(soa);
+    ids = mvsoa_col(soa, 0);
+    weights = mvsoa_col(soa, 1);
+    assert(ids[49] == 58 && weights[49] == 29.0);
+
+    fprintf(
+            stderr,
+            "Columns: %zu\n"
+            "Capacity: %zu\n"
+            "Whole size: %zu\n",
+            mvsoa_cols(soa), mvsoa_cap(soa), mvsize(soa)
+            );
+
+    mvfree(soa);
+}
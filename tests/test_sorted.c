@@ -0,0 +1,131 @@
+#include <assert.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#define MVEC_IMPLEMENTATION
+#define MVSORTED_IMPLEMENTATION
+#include "mvsorted.h"
+
+static int i32_comp(const void* _a, const void* _b) {
+    int32_t a = *(const int32_t*)_a;
+    int32_t b = *(const int32_t*)_b;
+    if (a < b) return -1;
+    if (a > b) return 1;
+    return 0;
+}
+
+typedef struct {
+    int32_t key;
+    double value;
+} Entry;
+
+static int entry_comp(const void* _a, const void* _b) {
+    return i32_comp(&((const Entry*)_a)->key, &((const Entry*)_b)->key);
+}
+
+static void assert_set(mvdef int32_t* iv) {
+    for (size_t i = 1; i < *mvlen(iv); i++)
+        assert(iv[i - 1] < iv[i]);
+}
+
+int main(void) {
+    srand(1337);
+    mvdef int32_t* set = mvalloc(4, sizeof(int32_t));
+    assert(set);
+    for (size_t i = 0; i < 1000; i++) {
+        int32_t key = rand() % 2000;
+        assert((set = mvsorted_insert(set, &key, i32_comp)));
+    }
+    assert_set(set);
+
+    // Searches agree with a linear scan, including keys out of range
+    mvdef int32_t* eytzinger = mvsorted_toEytzinger(set);
+    assert(eytzinger);
+    for (int32_t key = -1; key <= 2001; key++) {
+        size_t lower = 0;
+        while (lower < *mvlen(set) && set[lower] < key) lower++;
+        size_t upper = lower;
+        while (upper < *mvlen(set) && set[upper] <= key) upper++;
+        assert(mvsorted_lowerBound(set, &key, i32_comp) == lower);
+        assert(mvsorted_upperBound(set, &key, i32_comp) == upper);
+        assert(mvsorted_lowerBoundI32(set, key) == lower);
+        assert(mvsorted_upperBoundI32(set, key) == upper);
+
+        size_t e = mvsorted_eytzingerLowerBound(eytzinger, &key, i32_comp);
+        assert(e == mvsorted_eytzingerLowerBoundI32(eytzinger, key));
+        if (lower == *mvlen(set)) assert(e == *mvlen(eytzinger));
+        else assert(eytzinger[e] == set[lower]);
+
+        size_t found = mvsorted_find(set, &key, i32_comp);
+        assert(found == (lower < upper ? lower : *mvlen(set)));
+    }
+    mvfree(eytzinger);
+
+    // Erasing every present odd key leaves only even ones
+    size_t evens = 0;
+    for (size_t i = 0; i < *mvlen(set); i++)
+        evens += set[i] % 2 == 0;
+    for (int32_t key = 1; key < 2000; key += 2)
+        mvsorted_erase(set, &key, i32_comp);
+    assert(*mvlen(set) == evens);
+    for (size_t i = 0; i < *mvlen(set); i++)
+        assert(set[i] % 2 == 0);
+
+    // Batch merge of every multiple of 3
+    int32_t batch[700];
+    size_t batch_len = 0;
+    for (int32_t key = 0; key < 2100; key += 3)
+        batch[batch_len++] = key;
+    mvdef int32_t* batch_mvec = mvalloc(batch_len, sizeof(int32_t));
+    assert(batch_mvec);
+    for (size_t i = 0; i < batch_len; i++)
+        batch_mvec[(*mvlen(batch_mvec))++] = batch[i];
+    mvdef int32_t* expected = mvsorted_union(set, batch_mvec, i32_comp);
+    assert(expected);
+    mvdef int32_t* expected_i32 = mvsorted_unionI32(set, batch_mvec);
+    assert(expected_i32);
+    assert(*mvlen(expected) == *mvlen(expected_i32));
+
+    mvdef int32_t* common = mvsorted_intersection(set, batch_mvec, i32_comp);
+    mvdef int32_t* common_i32 = mvsorted_intersectionI32(set, batch_mvec);
+    assert(common && common_i32);
+    assert(*mvlen(common) == *mvlen(common_i32));
+    for (size_t i = 0; i < *mvlen(common); i++) {
+        assert(common[i] == common_i32[i]);
+        assert(common[i] % 6 == 0);
+    }
+    assert(*mvlen(expected) + *mvlen(common) == *mvlen(set) + batch_len);
+
+    assert((set = mvsorted_merge(set, batch, batch_len, i32_comp)));
+    assert_set(set);
+    assert(*mvlen(set) == *mvlen(expected));
+    for (size_t i = 0; i < *mvlen(set); i++)
+        assert(set[i] == expected[i] && set[i] == expected_i32[i]);
+
+    fprintf(
+            stderr,
+            "Set length: %zu\n"
+            "Common with multiples of 3: %zu\n",
+            *mvlen(set), *mvlen(common)
+            );
+
+    mvfree(set);
+    mvfree(batch_mvec);
+    mvfree(expected);
+    mvfree(expected_i32);
+    mvfree(common);
+    mvfree(common_i32);
+
+    // Flat map: inserting an existing key overwrites its value
+    mvdef Entry* map = mvalloc(0, sizeof(Entry));
+    assert(map);
+    for (int32_t i = 0; i < 20; i++) {
+        Entry entry = { .key = i % 10, .value = i };
+        assert((map = mvsorted_insert(map, &entry, entry_comp)));
+    }
+    assert(*mvlen(map) == 10);
+    Entry key = { .key = 7 };
+    size_t index = mvsorted_find(map, &key, entry_comp);
+    assert(index == 7 && map[index].value == 17.0);
+    mvfree(map);
+}
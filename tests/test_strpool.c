@@ -0,0 +1,105 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+#define MVSTRPOOL_IMPLEMENTATION
+#include "mvstrpool.h"
+
+static const size_t AMOUNT_WORDS = 50000;
+static const size_t DISTINCT_WORDS = 1000;
+
+static size_t word(size_t n, char* buffer) {
+    return (size_t)sprintf(buffer, "w%zu", n * 7919 % DISTINCT_WORDS);
+}
+
+int main(void) {
+    // Records are any bytes, including '\0' and empty ones
+    mvstrpool_t* pool = mvstrpool_alloc(0, 0, 0);
+    assert(pool && mvstrpool_len(pool) == 0);
+    assert(mvstrpool_append(pool, "hello", 5) == 0);
+    assert(mvstrpool_append(pool, "", 0) == 1);
+    assert(mvstrpool_append(pool, "a\0b", 3) == 2);
+    assert(mvstrpool_append(pool, "hello", 5) == 3);
+    assert(mvstrpool_len(pool) == 4);
+    assert(!strcmp(mvstrpool_get(pool, 0), "hello"));
+    assert(mvstrpool_size(pool, 1) == 0 && !*mvstrpool_get(pool, 1));
+    assert(mvstrpool_size(pool, 2) == 3);
+    assert(!memcmp(mvstrpool_get(pool, 2), "a\0b", 4));
+    assert(mvstrpool_find(pool, "hello", 5) == 0);
+    assert(mvstrpool_find(pool, "hell", 4) == MVSTRPOOL_NONE);
+
+    // Sorting keeps equal records in order and reports the permutation
+    mvdef size_t* order = mvalloc(mvstrpool_len(pool), sizeof(size_t));
+    assert(order);
+    assert(mvstrpool_sort(pool, order));
+    assert(*mvlen(order) == 4);
+    assert(order[0] == 1 && order[1] == 2 && order[2] == 0 && order[3] == 3);
+    assert(!strcmp(mvstrpool_get(pool, 2), "hello"));
+    assert(mvstrpool_get(pool, 3) == mvstrpool_get(pool, 2) + 6);
+    mvfree(order);
+    mvstrpool_free(pool);
+
+    // Interning pools keep one copy of each word
+    pool = mvstrpool_alloc(4, 16, 1);
+    assert(pool);
+    char buffer[32];
+    for (size_t i = 0; i < AMOUNT_WORDS; i++) {
+        size_t size = word(i, buffer);
+        size_t index = mvstrpool_append(pool, buffer, size);
+        assert(index < DISTINCT_WORDS);
+        assert(mvstrpool_size(pool, index) == size);
+        assert(!strcmp(mvstrpool_get(pool, index), buffer));
+    }
+    assert(mvstrpool_len(pool) == DISTINCT_WORDS);
+    assert(mvstrpool_sort(pool, NULL));
+    for (size_t i = 1; i < DISTINCT_WORDS; i++)
+        assert(strcmp(mvstrpool_get(pool, i - 1), mvstrpool_get(pool, i)) < 0);
+    for (size_t i = 0; i < DISTINCT_WORDS; i++) {
+        size_t size = word(i, buffer);
+        size_t index = mvstrpool_find(pool, buffer, size);
+        assert(index != MVSTRPOOL_NONE);
+        assert(!strcmp(mvstrpool_get(pool, index), buffer));
+        assert(mvstrpool_append(pool, buffer, size) == index);
+    }
+
+    // A serialized pool is one buffer restored by copying it
+    mvdef char* image = mvstrpool_serialize(pool);
+    assert(image);
+    assert(*mvlen(image) == sizeof(MvstrpoolImage)
+            + (DISTINCT_WORDS + 1) * sizeof(uint64_t) + *mvlen(pool->bytes));
+    mvstrpool_t* copy = mvstrpool_deserialize(image, *mvlen(image), 1);
+    assert(copy && mvstrpool_len(copy) == DISTINCT_WORDS);
+    for (size_t i = 0; i < DISTINCT_WORDS; i++) {
+        assert(!strcmp(mvstrpool_get(copy, i), mvstrpool_get(pool, i)));
+        size_t size = mvstrpool_size(pool, i);
+        assert(mvstrpool_find(copy, mvstrpool_get(pool, i), size) == i);
+    }
+    mvstrpool_free(copy);
+
+    // Broken buffers are rejected
+    assert(!mvstrpool_deserialize(image, *mvlen(image) - 1, 0));
+    image[sizeof(MvstrpoolImage) + 8] ^= 1;
+    assert(!mvstrpool_deserialize(image, *mvlen(image), 0));
+    image[sizeof(MvstrpoolImage) + 8] ^= 1;
+    image[0] = 'X';
+    assert(!mvstrpool_deserialize(image, *mvlen(image), 0));
+    mvfree(image);
+
+    // So are equal records in a buffer for an interning pool
+    mvstrpool_t* twice = mvstrpool_alloc(2, 2, 0);
+    assert(twice);
+    assert(mvstrpool_append(twice, "x", 1) == 0);
+    assert(mvstrpool_append(twice, "x", 1) == 1);
+    image = mvstrpool_serialize(twice);
+    assert(image);
+    assert(!mvstrpool_deserialize(image, *mvlen(image), 1));
+    copy = mvstrpool_deserialize(image, *mvlen(image), 0);
+    assert(copy && mvstrpool_len(copy) == 2);
+    mvstrpool_free(copy);
+    mvfree(image);
+    mvstrpool_free(twice);
+    fprintf(stderr, "%zu bytes for %zu words\n",
+            *mvlen(pool->bytes), mvstrpool_len(pool));
+    mvstrpool_free(pool);
+}
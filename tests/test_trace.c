@@ -0,0 +1,165 @@
+#include <assert.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#define MVEC_TRACE
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+
+static const char* const TRACE_PATH = "test_trace.bin";
+static const size_t THREAD_VECTORS = 3000;
+
+// Produces more events than a single thread buffer holds
+static void* worker(void* arg) {
+    (void)arg;
+    for (size_t i = 0; i < THREAD_VECTORS; i++) {
+        mvdef char* v = mvalloc(1, 1);
+        assert(v);
+        mvfree(v);
+    }
+    mvec_traceFlush();
+    return NULL;
+}
+
+static pthread_barrier_t barrier;
+
+// Buffers events while one trace file is open and flushes them after the next
+// one is opened
+static void* late_flusher(void* arg) {
+    (void)arg;
+    mvfree(mvalloc(1, 1));
+    pthread_barrier_wait(&barrier);
+    pthread_barrier_wait(&barrier);
+    mvec_traceFlush();
+    return NULL;
+}
+
+int main(void) {
+    // Vectors allocated before the trace is open are never recorded
+    mvdef int* untraced = mvalloc(4, sizeof(int));
+    assert(untraced);
+    assert(mvhead(untraced)->trace_id == 0);
+
+    assert(mvec_traceOpen(TRACE_PATH));
+    pthread_t thread;
+    assert(!pthread_create(&thread, NULL, worker, NULL));
+
+    mvdef int* iv = mvalloc(2, sizeof(int));
+    assert(iv);
+    uint64_t iv_id = mvhead(iv)->trace_id;
+    assert(iv_id);
+    iv[(*mvlen(iv))++] = 1;
+    iv[(*mvlen(iv))++] = 2;
+    iv = mvresize(iv, 64);
+    assert(iv);
+    mvdef int* copy = mvcopy(iv, 8);
+    assert(copy);
+    uint64_t copy_id = mvhead(copy)->trace_id;
+    assert(copy_id && copy_id != iv_id);
+    int* normal = mvec_toNormal(copy, NULL, NULL);
+    assert(normal);
+    mvdef int* back = mvec_fromNormal(normal, 2, sizeof(int));
+    assert(back);
+    uint64_t back_id = mvhead(back)->trace_id;
+    // Vectors allocated like another one get their own ids
+    mvdef short* shorts = mvalloc(1, sizeof(short));
+    assert(shorts);
+    mvdef short* like = mvalloc_like(shorts, 4);
+    assert(like);
+    uint64_t like_id = mvhead(like)->trace_id;
+    assert(like_id && like_id != mvhead(shorts)->trace_id);
+    mvfree(like);
+    mvfree(shorts);
+    untraced = mvresize(untraced, 8);
+    assert(untraced);
+    mvfree(untraced);
+    mvfree(back);
+    mvfree(iv);
+
+    assert(!pthread_join(thread, NULL));
+    mvec_traceClose();
+
+    // Nothing gets recorded after closing
+    mvfree(mvalloc(1, 1));
+
+    FILE* file = fopen(TRACE_PATH, "rb");
+    assert(file);
+    char magic[8];
+    assert(fread(magic, 1, 8, file) == 8);
+    assert(!memcmp(magic, MVEC_TRACE_MAGIC, 8));
+    size_t count = 2 * THREAD_VECTORS + 12;
+    MvecTraceEvent* events = malloc((count + 1) * sizeof(MvecTraceEvent));
+    assert(events);
+    assert(fread(events, sizeof(MvecTraceEvent), count + 1, file) == count);
+    fclose(file);
+    remove(TRACE_PATH);
+
+    // A thread's events keep their order in the file
+    MvecTraceEvent main_events[8];
+    size_t main_count = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (events[i].element_size != sizeof(int)) continue;
+        assert(main_count < 8);
+        main_events[main_count++] = events[i];
+    }
+    assert(main_count == 8);
+    const MvecTraceEvent* e = main_events;
+
+    assert(e[0].type == MVEC_TRACE_ALLOC && e[0].id == iv_id);
+    assert(e[0].old_capacity == 0 && e[0].new_capacity == 2);
+    assert(e[1].type == MVEC_TRACE_RESIZE && e[1].id == iv_id);
+    assert(e[1].old_capacity == 2 && e[1].new_capacity == 64);
+    assert(e[1].length == 2);
+    assert(e[2].type == MVEC_TRACE_ALLOC && e[2].id == copy_id);
+    assert(e[3].type == MVEC_TRACE_COPY && e[3].id == copy_id);
+    assert(e[3].parent == iv_id && e[3].length == 2 && e[3].moved);
+    assert(e[3].old_capacity == 64 && e[3].new_capacity == 8);
+    assert(e[4].type == MVEC_TRACE_TO_NORMAL && e[4].id == copy_id);
+    assert(e[4].old_capacity == 8 && e[4].new_capacity == 2);
+    assert(e[5].type == MVEC_TRACE_FROM_NORMAL && e[5].id == back_id);
+    assert(e[5].new_capacity == 2 && e[5].length == 2);
+    assert(e[6].type == MVEC_TRACE_FREE && e[6].id == back_id);
+    assert(e[7].type == MVEC_TRACE_FREE && e[7].id == iv_id);
+    assert(e[7].old_capacity == 64 && e[7].new_capacity == 0);
+    for (size_t i = 1; i < 8; i++)
+        assert(e[i - 1].timestamp <= e[i].timestamp);
+
+    size_t like_events = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (events[i].element_size != sizeof(short)
+                || events[i].id != like_id)
+            continue;
+        assert(like_events || events[i].type == MVEC_TRACE_ALLOC);
+        assert(like_events || events[i].new_capacity == 4);
+        like_events++;
+    }
+    assert(like_events == 2);
+
+    // Every vector of the worker thread is allocated and freed
+    size_t allocs = 0, frees = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (events[i].element_size != 1) continue;
+        allocs += events[i].type == MVEC_TRACE_ALLOC;
+        frees += events[i].type == MVEC_TRACE_FREE;
+    }
+    assert(allocs == THREAD_VECTORS && frees == THREAD_VECTORS);
+    free(events);
+    fprintf(stderr, "%zu events recorded\n", count);
+
+    // Events buffered when a trace file gets closed don't leak into the next
+    assert(!pthread_barrier_init(&barrier, NULL, 2));
+    assert(mvec_traceOpen(TRACE_PATH));
+    assert(!pthread_create(&thread, NULL, late_flusher, NULL));
+    pthread_barrier_wait(&barrier);
+    assert(mvec_traceOpen(TRACE_PATH));
+    pthread_barrier_wait(&barrier);
+    assert(!pthread_join(thread, NULL));
+    mvec_traceClose();
+    pthread_barrier_destroy(&barrier);
+    file = fopen(TRACE_PATH, "rb");
+    assert(file);
+    assert(fseek(file, 0, SEEK_END) == 0 && ftell(file) == 8);
+    fclose(file);
+    remove(TRACE_PATH);
+}
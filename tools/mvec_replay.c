@@ -0,0 +1,500 @@
+// Replays a trace recorded with MVEC_TRACE against different allocators and
+// growth factors and reports time, peak RSS and the amount of copied bytes.
+//
+// Usage: mvec_replay TRACE [-a ALLOCATOR]... [-g GROWTH]...
+//  ALLOCATOR: libc (realloc), copying (malloc+memcpy+free on every resize) or
+//   mremap (vectors of MAP_THRESHOLD bytes or larger get their own mappings
+//   moved with mremap(); Linux only). All of them by default.
+//  GROWTH: 0 replays the capacities recorded in the trace. A factor above 1
+//   ignores the recorded growth: the capacity is multiplied by the factor
+//   until it fits the recorded length. 0, 1.5 and 2 by default.
+//
+// Every configuration is replayed in a separate child process so its peak RSS
+// is not affected by the others. Elements are written as the recorded length
+// grows, so the touched memory matches the traced program. Chunks produced by
+// mvec_toNormal() are freed right away since their lifetime is not traced.
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#define MVEC_TRACE
+#define MVEC_CUSTOM_ALLOCATORS
+#define MVEC_IMPLEMENTATION
+#include "mvec.h"
+
+#define PREFIX 16
+#define MAP_THRESHOLD (128 * 1024)
+
+typedef struct {
+    double seconds;
+    size_t peak_live;
+    size_t copied;
+    size_t moves;
+    size_t skipped;
+} Result;
+
+typedef struct {
+    mvec_t* mvec;
+    size_t filled;
+} Slot;
+
+static size_t copied = 0;
+static size_t moves = 0;
+
+// Every allocator keeps the size of a chunk in front of it to know how many
+// bytes its realloc() copies
+
+static inline size_t* prefixOf(void* ptr) {
+    return (size_t*)((char*)ptr - PREFIX);
+}
+
+static inline size_t minSize(size_t a, size_t b) {
+    return a < b ? a : b;
+}
+
+static void* libcMalloc(size_t bytes) {
+    size_t* prefix = malloc(PREFIX + bytes);
+    if (!prefix) return NULL;
+    prefix[0] = bytes;
+    return (char*)prefix + PREFIX;
+}
+
+static void* libcRealloc(void* ptr, size_t bytes) {
+    if (!ptr) return libcMalloc(bytes);
+    size_t old_bytes = prefixOf(ptr)[0];
+    uintptr_t old_address = (uintptr_t)prefixOf(ptr);
+    size_t* prefix = realloc(prefixOf(ptr), PREFIX + bytes);
+    if (!prefix) return NULL;
+    if ((uintptr_t)prefix != old_address) {
+        copied += minSize(old_bytes, bytes);
+        moves++;
+    }
+    prefix[0] = bytes;
+    return (char*)prefix + PREFIX;
+}
+
+static void libcFree(void* ptr) {
+    free(prefixOf(ptr));
+}
+
+static void* copyingRealloc(void* ptr, size_t bytes) {
+    if (!ptr) return libcMalloc(bytes);
+    void* new_ptr = libcMalloc(bytes);
+    if (!new_ptr) return NULL;
+    size_t old_bytes = prefixOf(ptr)[0];
+    memcpy(new_ptr, ptr, minSize(old_bytes, bytes));
+    copied += minSize(old_bytes, bytes);
+    moves++;
+    libcFree(ptr);
+    return new_ptr;
+}
+
+#ifdef __linux__
+// prefix[1] is the size of the mapping or 0 for chunks taken from malloc()
+
+static size_t mapSize(size_t bytes) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    return (PREFIX + bytes + page - 1) / page * page;
+}
+
+static void* mremapMalloc(size_t bytes) {
+    size_t* prefix;
+    if (bytes < MAP_THRESHOLD) {
+        prefix = malloc(PREFIX + bytes);
+        if (!prefix) return NULL;
+        prefix[1] = 0;
+    } else {
+        prefix = mmap(
+                NULL, mapSize(bytes), PROT_READ | PROT_WRITE,
+                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0
+                );
+        if (prefix == MAP_FAILED) return NULL;
+        prefix[1] = mapSize(bytes);
+    }
+    prefix[0] = bytes;
+    return (char*)prefix + PREFIX;
+}
+
+static void mremapFree(void* ptr) {
+    size_t* prefix = prefixOf(ptr);
+    if (prefix[1]) munmap(prefix, prefix[1]);
+    else free(prefix);
+}
+
+static void* mremapRealloc(void* ptr, size_t bytes) {
+    if (!ptr) return mremapMalloc(bytes);
+    size_t* prefix = prefixOf(ptr);
+    if (prefix[1] && bytes >= MAP_THRESHOLD) {
+        uintptr_t old_address = (uintptr_t)prefix;
+        prefix = mremap(prefix, prefix[1], mapSize(bytes), MREMAP_MAYMOVE);
+        if (prefix == MAP_FAILED) return NULL;
+        moves += (uintptr_t)prefix != old_address;
+        prefix[0] = bytes;
+        prefix[1] = mapSize(bytes);
+        return (char*)prefix + PREFIX;
+    }
+    if (!prefix[1] && bytes < MAP_THRESHOLD)
+        return libcRealloc(ptr, bytes);
+    // Crossing the threshold in either direction
+    void* new_ptr = mremapMalloc(bytes);
+    if (!new_ptr) return NULL;
+    memcpy(new_ptr, ptr, minSize(prefix[0], bytes));
+    copied += minSize(prefix[0], bytes);
+    moves++;
+    mremapFree(ptr);
+    return new_ptr;
+}
+#endif // __linux__
+
+static const struct {
+    const char* name;
+    allocfunc_t malloc;
+    reallocfunc_t realloc;
+    freefunc_t free;
+} ALLOCATORS[] = {
+    {"libc", libcMalloc, libcRealloc, libcFree},
+    {"copying", libcMalloc, copyingRealloc, libcFree},
+#ifdef __linux__
+    {"mremap", mremapMalloc, mremapRealloc, mremapFree},
+#endif // __linux__
+};
+#define ALLOCATOR_COUNT (sizeof(ALLOCATORS) / sizeof(ALLOCATORS[0]))
+
+static mvdef MvecTraceEvent* events = NULL;
+static mvdef size_t* order = NULL;
+// Length of the vector at its next event, i.e. how far the program fills it
+// after the given event
+static mvdef uint64_t* lookahead = NULL;
+
+static int byTimestamp(const void* a, const void* b) {
+    const MvecTraceEvent* ea = &events[*(const size_t*)a];
+    const MvecTraceEvent* eb = &events[*(const size_t*)b];
+    if (ea->timestamp != eb->timestamp)
+        return ea->timestamp < eb->timestamp ? -1 : 1;
+    // Keep the order of the events recorded at the same time by one thread
+    return *(const size_t*)a < *(const size_t*)b ? -1 : 1;
+}
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// Exits if the replay failed to allocate memory
+static void* checked(void* ptr) {
+    if (!ptr) {
+        perror("replaying the trace");
+        exit(EXIT_FAILURE);
+    }
+    return ptr;
+}
+
+// Writes the elements the traced program had written by the time it reached
+// the given length. With a growth factor, grows the vector on the way as a
+// program pushing elements one by one would.
+static void reach(Slot* slot, size_t length, double growth, size_t* live) {
+    while (growth > 1 && mvcap(slot->mvec) < length) {
+        size_t capacity = mvcap(slot->mvec);
+        size_t next = (size_t)(capacity * growth);
+        *live -= mvsize(slot->mvec);
+        slot->mvec = checked(
+                mvresize(slot->mvec, next > capacity ? next : capacity + 1)
+                );
+        *live += mvsize(slot->mvec);
+    }
+    size_t capacity = mvcap(slot->mvec);
+    if (length > capacity) length = capacity;
+    if (length > slot->filled) {
+        memset(
+                (char*)slot->mvec + slot->filled * mvelsz(slot->mvec),
+                0xA5,
+                (length - slot->filled) * mvelsz(slot->mvec)
+              );
+        slot->filled = length;
+    }
+    *mvlen(slot->mvec) = length;
+}
+
+static Result replay(size_t slot_count, double growth) {
+    Result result = {0};
+    Slot* slots = checked(calloc(slot_count, sizeof(Slot)));
+    size_t live = 0;
+    double start = now();
+    for (size_t i = 0; i < *mvlen(order); i++) {
+        const MvecTraceEvent* e = &events[order[i]];
+        Slot* slot = &slots[e->id];
+        Slot* parent = &slots[e->parent];
+        size_t bytes = e->new_capacity * e->element_size;
+        int creates = e->type == MVEC_TRACE_ALLOC
+            || e->type == MVEC_TRACE_FROM_NORMAL;
+        if (creates == !!slot->mvec
+                || (e->type == MVEC_TRACE_COPY && !parent->mvec)) {
+            // The events of the vector are not complete, e.g. some thread
+            // didn't flush its buffer
+            result.skipped++;
+            continue;
+        }
+        switch (e->type) {
+        case MVEC_TRACE_ALLOC:
+            slot->mvec = checked(mvalloc(e->new_capacity, e->element_size));
+            slot->filled = 0;
+            live += mvsize(slot->mvec);
+            break;
+        case MVEC_TRACE_RESIZE:
+            reach(slot, e->length, growth, &live);
+            // With a growth factor only shrinking is replayed as is
+            if (growth > 1 && e->new_capacity >= e->old_capacity) break;
+            live -= mvsize(slot->mvec);
+            slot->mvec = checked(mvresize(slot->mvec, e->new_capacity));
+            if (slot->filled > e->new_capacity)
+                slot->filled = e->new_capacity;
+            live += mvsize(slot->mvec);
+            break;
+        case MVEC_TRACE_COPY:
+            reach(parent, e->length, growth, &live);
+            memcpy(slot->mvec, parent->mvec, e->length * e->element_size);
+            copied += e->length * e->element_size;
+            *mvlen(slot->mvec) = slot->filled = e->length;
+            break;
+        case MVEC_TRACE_FREE:
+            reach(slot, e->length, growth, &live);
+            live -= mvsize(slot->mvec);
+            mvfree(slot->mvec);
+            slot->mvec = NULL;
+            break;
+        case MVEC_TRACE_FROM_NORMAL: {
+            void* normal = checked(mvec_current_allocator.malloc(bytes));
+            memset(normal, 0xA5, bytes);
+            slot->mvec = checked(
+                    mvec_fromNormal(normal, e->new_capacity, e->element_size)
+                    );
+            copied += bytes;
+            slot->filled = e->new_capacity;
+            live += mvsize(slot->mvec);
+            break;
+        }
+        case MVEC_TRACE_TO_NORMAL:
+            reach(slot, e->length, growth, &live);
+            live -= mvsize(slot->mvec);
+            copied += *mvlen(slot->mvec) * e->element_size;
+            mvec_current_allocator.free(
+                    checked(mvec_toNormal(slot->mvec, NULL, NULL))
+                    );
+            slot->mvec = NULL;
+            break;
+        default:
+            result.skipped++;
+            break;
+        }
+        if (slot->mvec) reach(slot, lookahead[order[i]], growth, &live);
+        if (live > result.peak_live) result.peak_live = live;
+    }
+    result.seconds = now() - start;
+    for (size_t i = 0; i < slot_count; i++)
+        if (slots[i].mvec) mvfree(slots[i].mvec);
+    free(slots);
+    result.copied = copied;
+    result.moves = moves;
+    return result;
+}
+
+static int load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        perror(path);
+        return 0;
+    }
+    char magic[8];
+    if (fread(magic, 1, 8, file) != 8 || memcmp(magic, MVEC_TRACE_MAGIC, 8)) {
+        fprintf(stderr, "%s: not an mvec trace\n", path);
+        fclose(file);
+        return 0;
+    }
+    events = mvalloc(1024, sizeof(MvecTraceEvent));
+    while (events) {
+        if (*mvlen(events) == mvcap(events)) {
+            mvdef MvecTraceEvent* grown = mvresize(events, mvcap(events) * 2);
+            if (!grown) break;
+            events = grown;
+        }
+        size_t read = fread(
+                events + *mvlen(events),
+                sizeof(MvecTraceEvent),
+                mvcap(events) - *mvlen(events),
+                file
+                );
+        *mvlen(events) += read;
+        if (!read) break;
+    }
+    int failed = !events || ferror(file);
+    fclose(file);
+    if (failed) {
+        perror(path);
+        return 0;
+    }
+    return 1;
+}
+
+static void usage(const char* program) {
+    fprintf(
+            stderr,
+            "Usage: %s TRACE [-a ALLOCATOR]... [-g GROWTH]...\n"
+            "ALLOCATOR: libc, copying"
+#ifdef __linux__
+            ", mremap"
+#endif // __linux__
+            "\nGROWTH: 0 (as traced) or a factor above 1\n",
+            program
+           );
+    exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv) {
+    mvdef size_t* allocators = NULL;
+    mvdef double* growths = NULL;
+    const char* path = NULL;
+    mvec_setAllocator(libcMalloc, libcRealloc, libcFree);
+    allocators = mvalloc(ALLOCATOR_COUNT, sizeof(size_t));
+    growths = mvalloc(argc + 3, sizeof(double));
+    if (!allocators || !growths) {
+        perror("mvalloc");
+        return EXIT_FAILURE;
+    }
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "-a") && i + 1 < argc) {
+            size_t a = 0;
+            while (a < ALLOCATOR_COUNT && strcmp(ALLOCATORS[a].name, argv[i+1]))
+                a++;
+            if (a == ALLOCATOR_COUNT || *mvlen(allocators) == ALLOCATOR_COUNT)
+                usage(argv[0]);
+            allocators[(*mvlen(allocators))++] = a;
+            i++;
+        } else if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+            double growth = atof(argv[++i]);
+            if (growth != 0 && !(growth > 1)) usage(argv[0]);
+            growths[(*mvlen(growths))++] = growth;
+        } else if (!path && argv[i][0] != '-') {
+            path = argv[i];
+        } else {
+            usage(argv[0]);
+        }
+    }
+    if (!path) usage(argv[0]);
+    if (!*mvlen(allocators))
+        for (size_t a = 0; a < ALLOCATOR_COUNT; a++)
+            allocators[(*mvlen(allocators))++] = a;
+    if (!*mvlen(growths)) {
+        growths[(*mvlen(growths))++] = 0;
+        growths[(*mvlen(growths))++] = 1.5;
+        growths[(*mvlen(growths))++] = 2;
+    }
+    if (!load(path)) return EXIT_FAILURE;
+
+    size_t event_count = *mvlen(events);
+    order = mvalloc(event_count, sizeof(size_t));
+    if (!order) {
+        perror("mvalloc");
+        return EXIT_FAILURE;
+    }
+    size_t max_id = 0;
+    for (size_t i = 0; i < event_count; i++) {
+        order[i] = i;
+        if (events[i].id > max_id) max_id = events[i].id;
+        // The parent's own events may be missing from a truncated trace
+        if (events[i].parent > max_id) max_id = events[i].parent;
+    }
+    *mvlen(order) = event_count;
+    qsort(order, event_count, sizeof(size_t), byTimestamp);
+    lookahead = mvalloc(event_count, sizeof(uint64_t));
+    mvdef uint64_t* last_length = mvalloc(max_id + 1, sizeof(uint64_t));
+    if (!lookahead || !last_length) {
+        perror("mvalloc");
+        return EXIT_FAILURE;
+    }
+    memset(last_length, 0, (max_id + 1) * sizeof(uint64_t));
+    for (size_t i = event_count; i--;) {
+        const MvecTraceEvent* e = &events[order[i]];
+        lookahead[order[i]] = last_length[e->id];
+        last_length[e->id] = e->length;
+    }
+    mvfree(last_length);
+    double duration = event_count
+        ? (events[order[event_count - 1]].timestamp
+                - events[order[0]].timestamp) * 1e-9
+        : 0;
+    printf(
+            "%s: %zu events, %zu vectors, %.3f s traced\n\n",
+            path, event_count, max_id, duration
+          );
+    printf(
+            "%-10s %-8s %10s %14s %15s %13s %9s\n",
+            "allocator", "growth", "time (ms)", "peak RSS (MiB)",
+            "peak live (MiB)", "copied (MiB)", "moves"
+          );
+
+    for (size_t a = 0; a < *mvlen(allocators); a++) {
+        for (size_t g = 0; g < *mvlen(growths); g++) {
+            int fds[2];
+            if (pipe(fds)) {
+                perror("pipe");
+                return EXIT_FAILURE;
+            }
+            fflush(stdout);
+            pid_t pid = fork();
+            if (pid < 0) {
+                perror("fork");
+                return EXIT_FAILURE;
+            }
+            if (!pid) {
+                close(fds[0]);
+                mvec_setAllocator(
+                        ALLOCATORS[allocators[a]].malloc,
+                        ALLOCATORS[allocators[a]].realloc,
+                        ALLOCATORS[allocators[a]].free
+                        );
+                Result result = replay(max_id + 1, growths[g]);
+                ssize_t written = write(fds[1], &result, sizeof(result));
+                _exit(written == sizeof(result) ? EXIT_SUCCESS : EXIT_FAILURE);
+            }
+            close(fds[1]);
+            Result result;
+            ssize_t got = read(fds[0], &result, sizeof(result));
+            close(fds[0]);
+            int status;
+            struct rusage usage;
+            if (wait4(pid, &status, 0, &usage) < 0 || got != sizeof(result)
+                    || !WIFEXITED(status) || WEXITSTATUS(status)) {
+                fprintf(
+                        stderr, "replay with %s failed\n",
+                        ALLOCATORS[allocators[a]].name
+                       );
+                return EXIT_FAILURE;
+            }
+            char growth[16] = "traced";
+            if (growths[g] > 1)
+                snprintf(growth, sizeof(growth), "%.2f", growths[g]);
+            printf(
+                    "%-10s %-8s %10.2f %14.1f %15.1f %13.1f %9zu\n",
+                    ALLOCATORS[allocators[a]].name, growth,
+                    result.seconds * 1e3,
+                    usage.ru_maxrss / 1024.0,
+                    result.peak_live / 1048576.0,
+                    result.copied / 1048576.0,
+                    result.moves
+                  );
+            if (result.skipped)
+                printf("  (%zu incomplete events skipped)\n", result.skipped);
+        }
+    }
+    mvfree(lookahead);
+    mvfree(order);
+    mvfree(events);
+    mvfree(allocators);
+    mvfree(growths);
+}